@@ -3,7 +3,7 @@
 *
 * ADBeta (c) 2025
 ******************************************************************************/
-#include "mini-math.h"
+#include "mini_math.h"
 
 // Function to calculate cosine using an improved Taylor series with 5 terms
 float mini_cos(float x)
@@ -0,0 +1,70 @@
+/******************************************************************************
+* Host stand-in for ch32v003fun.h - Used by the host-native benchmark only.
+* Replaces the registers and timing functions touched by insomniac.c with
+* plain variables, so the motion engine can run on Linux.
+* The simulated SysTick counts at FUNCONF_SYSTEM_CORE_CLOCK like the real one.
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#ifndef INSOMNIAC_HOST_CH32V003FUN_H
+#define INSOMNIAC_HOST_CH32V003FUN_H
+
+#include <stdint.h>
+#include "funconfig.h"
+
+/*** Clock / Timing **********************************************************/
+#define FUNCONF_SYSTEM_CORE_CLOCK 48000000
+#define DELAY_US_TIME ((FUNCONF_SYSTEM_CORE_CLOCK)/1000000)
+#define DELAY_MS_TIME ((FUNCONF_SYSTEM_CORE_CLOCK)/1000)
+
+#define Delay_Us(n) DelaySysTick( (n) * DELAY_US_TIME )
+#define Delay_Ms(n) DelaySysTick( (n) * DELAY_MS_TIME )
+#define Ticks_from_Ms(n)	(n * DELAY_MS_TIME)
+
+
+/*** Registers ***************************************************************/
+typedef struct {
+	volatile uint32_t CFGLR;
+	volatile uint32_t INDR;
+	volatile uint32_t OUTDR;
+} GPIO_TypeDef;
+
+typedef struct {
+	volatile uint32_t APB2PCENR;
+} RCC_TypeDef;
+
+typedef struct {
+	volatile uint32_t CNT;
+} SysTick_Type;
+
+extern GPIO_TypeDef  host_gpioa;
+extern GPIO_TypeDef  host_gpioc;
+extern RCC_TypeDef   host_rcc;
+extern SysTick_Type  host_systick;
+
+#define GPIOA    (&host_gpioa)
+#define GPIOC    (&host_gpioc)
+#define RCC      (&host_rcc)
+#define SysTick  (&host_systick)
+
+#define RCC_APB2Periph_GPIOA   0x00000004
+#define RCC_APB2Periph_GPIOC   0x00000010
+#define GPIO_CFGLR_IN_PUPD     0x08
+
+
+/*** Debug Module ************************************************************/
+// Defined by the tools that simulate a debugger
+extern volatile uint32_t host_dmdata[2];
+
+#define DMDATA0  (&host_dmdata[0])
+#define DMDATA1  (&host_dmdata[1])
+
+
+/*** Functions ***************************************************************/
+/// @brief Advances the simulated SysTick instead of waiting
+void DelaySysTick(uint32_t n);
+
+/// @brief Does nothing on the host
+void SystemInit(void);
+
+#endif
@@ -0,0 +1,170 @@
+/******************************************************************************
+* Host benchmark for screen coverage. Runs each random mode with independent
+* random endpoints and with the Halton sequence from halton.h, following the
+* cursor across a grid over the Virtual Cursor Box. Reports the percentage
+* of cells visited after a number of steps, and the steps it takes each
+* generator to visit half, 90% and 99% of the cells.
+*
+* Build and run with:    make host-coverage
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_firmware.h"
+
+
+/*** Benchmark Settings ******************************************************/
+#define COVER_CELL           16         // Grid cell size, units
+#define COVER_MAX_STEPS      4000000    // Give up on a coverage target after
+#define COVER_SEED           0x747AA32F
+#define COVER_GRID_W         ((2 * CURSOR_BOUND_X + COVER_CELL) / COVER_CELL)
+#define COVER_GRID_H         ((2 * CURSOR_BOUND_Y + COVER_CELL) / COVER_CELL)
+#define COVER_CELLS          (COVER_GRID_W * COVER_GRID_H)
+
+
+/// @brief Steps at which the coverage is printed
+static const uint32_t cover_checkpoints[] = {
+	10000, 30000, 100000, 300000, 1000000,
+};
+#define COVER_CHECKPOINTS    (sizeof(cover_checkpoints) / sizeof(cover_checkpoints[0]))
+
+
+/// @brief Coverage percentages to find the step count of
+static const uint8_t cover_targets[] = {50, 90, 99};
+#define COVER_TARGETS        (sizeof(cover_targets) / sizeof(cover_targets[0]))
+
+
+/// @brief Modes to run, in jumper order
+static const user_mode_t cover_modes[] = {
+	USER_MODE_NORMAL, USER_MODE_HI_RES, USER_MODE_JITTER,
+};
+
+
+/// @brief Results of one run
+typedef struct {
+	double           checkpoint[COVER_CHECKPOINTS];     // % of cells visited
+	uint32_t         target[COVER_TARGETS];             // Steps, 0 if never
+} cover_result_t;
+
+
+// A registry row with the plan overridden, and its planners
+static user_mode_desc_t cover_mode;
+static void cover_plan_random(void)  { move_to_endpoint(plan_endpoint(cover_mode.range)); }
+static void cover_plan_halton(void)  { move_to_endpoint(plan_cover()); }
+
+static uint8_t  cover_grid[COVER_GRID_H][COVER_GRID_W];
+
+
+
+/*** Simulation **************************************************************/
+/// @brief Marks the cell under the cursor, returns 1 if it is new
+static uint32_t cover_visit(const int32_t x, const int32_t y)
+{
+	uint8_t *cell = &cover_grid[(y + CURSOR_BOUND_Y) / COVER_CELL]
+	                           [(x + CURSOR_BOUND_X) / COVER_CELL];
+	if(*cell) return 0;
+
+	*cell = 1;
+	return 1;
+}
+
+
+/// @brief Runs a mode with the given plan until it passes every checkpoint
+/// and reaches every coverage target, or COVER_MAX_STEPS
+static cover_result_t cover_run(const user_mode_t mode, const user_mode_plan_t plan)
+{
+	cover_result_t res = {0};
+	memset(cover_grid, 0, sizeof(cover_grid));
+
+	host_firmware_reset(mode, COVER_SEED);
+
+	cover_mode      = *g_mode;
+	cover_mode.plan = plan;
+	g_mode          = &cover_mode;
+	g_plan          = (plan == USER_MODE_PLAN_COVER) ? cover_plan_halton : cover_plan_random;
+	if(plan == USER_MODE_PLAN_COVER) cover_setup();
+
+	// The cursor starts in the middle of the box, like the Virtual Cursor
+	int32_t  x = 0, y = 0;
+	uint32_t steps = 0, visited = cover_visit(x, y);
+	size_t   next_check = 0, next_target = 0;
+
+	while(steps < COVER_MAX_STEPS
+	   && (next_check < COVER_CHECKPOINTS || next_target < COVER_TARGETS))
+	{
+		motion_task();
+
+		host_packet_len = 0;
+		usb_handle_user_in_request(NULL, NULL, 1, 0, NULL);
+		DelaySysTick(Ticks_from_Ms(USB_POLL_INTERVAL_MS));
+
+		int8_t dx = (host_packet_len >= 3) ? (int8_t)host_packet[1] : 0;
+		int8_t dy = (host_packet_len >= 3) ? (int8_t)host_packet[2] : 0;
+
+		// Walk the Report one unit at a time, so no cell is skipped
+		while(dx || dy)
+		{
+			if(dx) { x += (dx > 0) ? 1 : -1;  dx -= (dx > 0) ? 1 : -1; }
+			else   { y += (dy > 0) ? 1 : -1;  dy -= (dy > 0) ? 1 : -1; }
+			visited += cover_visit(x, y);
+			steps++;
+
+			if(next_check < COVER_CHECKPOINTS && steps == cover_checkpoints[next_check])
+				res.checkpoint[next_check++] = 100.0 * visited / COVER_CELLS;
+
+			while(next_target < COVER_TARGETS
+			   && visited * 100 >= (uint32_t)cover_targets[next_target] * COVER_CELLS)
+				res.target[next_target++] = steps;
+		}
+	}
+
+	return res;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	int fails = 0;
+
+	printf("Coverage benchmark: %d x %d grid of %d unit cells over the Virtual Cursor Box\n\n",
+	       COVER_GRID_W, COVER_GRID_H, COVER_CELL);
+	printf("%-8s %-8s", "Mode", "Plan");
+	for(size_t c = 0; c < COVER_CHECKPOINTS; c++) printf(" %7uk", cover_checkpoints[c] / 1000);
+	for(size_t t = 0; t < COVER_TARGETS; t++) printf("  steps to %2u%%", cover_targets[t]);
+	printf("\n");
+
+	for(size_t m = 0; m < sizeof(cover_modes) / sizeof(cover_modes[0]); m++)
+	{
+		cover_result_t res[2] = {
+			cover_run(cover_modes[m], USER_MODE_PLAN_RANDOM),
+			cover_run(cover_modes[m], USER_MODE_PLAN_COVER),
+		};
+
+		for(int r = 0; r < 2; r++)
+		{
+			printf("%-8s %-8s", host_mode_names[cover_modes[m]], r ? "Halton" : "Random");
+			for(size_t c = 0; c < COVER_CHECKPOINTS; c++) printf(" %7.1f%%", res[r].checkpoint[c]);
+			for(size_t t = 0; t < COVER_TARGETS; t++)
+			{
+				if(res[r].target[t]) printf(" %14u", res[r].target[t]);
+				else                 printf(" %14s", "-");
+			}
+			printf("\n");
+		}
+
+		// Halton must reach every target, and sooner than random endpoints
+		for(size_t t = 0; t < COVER_TARGETS; t++)
+		{
+			if(res[1].target[t] == 0) fails++;
+			else if(res[0].target[t] && res[1].target[t] > res[0].target[t]) fails++;
+		}
+	}
+
+	printf("\nHalton endpoints cover the box sooner: %s\n\n", fails ? "FAIL" : "PASS");
+	return fails ? 1 : 0;
+}
@@ -0,0 +1,275 @@
+/******************************************************************************
+* Host test of the non-blocking debug printf ring in debug_print.c. Plays
+* the debugger on simulated DMDATA0/DMDATA1 registers, taking packets at
+* different rates while random writes fill the ring, and checks that every
+* byte arrives once and in order, that what didn't fit is counted as dropped,
+* that no packet is longer than the link carries, and that the drain never
+* writes over a packet the debugger hasn't taken. Also checks a detached
+* debugger only fills the ring, and times _write() and the drain.
+*
+* Build and run with:    make host-debug-print
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// debug_print.c replaces _write() and putchar() on the target, rename them
+// so the C library keeps its own
+#define _write   debug_print_write
+#define putchar  debug_print_putchar
+#include "debug_print.c"
+#undef putchar
+#undef _write
+
+
+/*** Test Settings ***********************************************************/
+#define DEBUG_TEST_OPS       4000000    // Random writes and drains per rate
+#define DEBUG_TEST_MAX_WRITE 40         // Longest random write, bytes
+#define DEBUG_TEST_TIMED     10000000   // Calls per timing loop
+#define DEBUG_TEST_SEED      0x747AA32F
+
+
+/// @brief Chance the debugger takes a waiting packet on each drain, percent
+static const uint8_t debug_test_rates[] = {100, 50, 10, 1};
+
+
+/// @brief Counts from one run
+typedef struct {
+	uint64_t         written;           // Bytes passed to _write()
+	uint64_t         accepted;          // Bytes _write() took
+	uint64_t         received;          // Bytes the debugger took
+	uint64_t         packets;
+	uint32_t         bad_byte;          // Arrived out of order or changed
+	uint32_t         bad_accept;        // Took more or less than the room
+	uint32_t         bad_packet;        // Empty or longer than the link
+	uint32_t         overwrite;         // Sent while the debugger was busy
+	uint32_t         bad_dropped;       // Drop counter doesn't match
+} debug_test_result_t;
+
+
+// The Debug Module data registers
+volatile uint32_t host_dmdata[2];
+
+// Bytes accepted but not yet received, in order, to check against. They
+// are in the ring or in the packet waiting on the link
+#define DEBUG_TEST_EXPECT    (DEBUG_PRINT_RING_SIZE * 2)
+static uint8_t  debug_test_expect[DEBUG_TEST_EXPECT];
+static uint32_t debug_test_expect_head, debug_test_expect_tail;
+static uint32_t debug_test_inflight;
+
+
+
+/*** Simulation **************************************************************/
+/// @brief Empties the ring and sets the link as SetupDebugPrintf() leaves it
+static void debug_test_reset(void)
+{
+	g_dbg_head     = 0;
+	g_dbg_tail     = 0;
+	g_dbg_dropped  = 0;
+	host_dmdata[0] = 0x80;
+	host_dmdata[1] = 0x00;
+
+	debug_test_expect_head = 0;
+	debug_test_expect_tail = 0;
+	debug_test_inflight    = 0;
+}
+
+
+/// @brief Takes the waiting packet like the debugger does, and clears the
+/// status to say it has been read
+/// @return Bytes in the packet, 0 if there was none
+static uint32_t debug_test_take(uint8_t *out)
+{
+	uint32_t d0 = host_dmdata[0];
+	uint32_t d1 = host_dmdata[1];
+	if(!(d0 & 0x80) || (d0 & 0x7F) < 4) return 0;
+
+	uint32_t len = (d0 & 0x7F) - 4;
+	for(uint32_t c = 0; c < len && c < 8; c++)
+	{
+		uint32_t place = c + 1;
+		uint32_t word  = (place < 4) ? d0 : d1;
+		out[c] = (uint8_t)(word >> ((place & 0x03) * 8));
+	}
+
+	host_dmdata[0] = 0x00;
+	return len;
+}
+
+
+/// @brief Random writes and drains, with the debugger taking packets at
+/// the given rate. Checks every byte against what _write() accepted
+static debug_test_result_t debug_test_run(const uint8_t rate)
+{
+	debug_test_result_t res = {0};
+	debug_test_reset();
+	host_dmdata[0] = 0x00;
+	srand(DEBUG_TEST_SEED);
+
+	char    msg[DEBUG_TEST_MAX_WRITE];
+	uint8_t packet[8];
+	uint8_t next = 0;
+
+	for(uint32_t op = 0; op < DEBUG_TEST_OPS; op++)
+	{
+		if(rand() & 1)
+		{
+			// A printf piece, or a single putchar
+			int size = (rand() & 3) ? rand() % (DEBUG_TEST_MAX_WRITE + 1) : -1;
+			int len  = (size < 0) ? 1 : size;
+			for(int c = 0; c < len; c++) msg[c] = (char)next++;
+
+			// The packet on the link has already left the ring
+			uint32_t room = DEBUG_PRINT_RING_SIZE + debug_test_inflight
+			              - (debug_test_expect_head - debug_test_expect_tail);
+			uint32_t fits = ((uint32_t)len < room) ? (uint32_t)len : room;
+
+			int took = (size < 0) ? debug_print_putchar((uint8_t)msg[0])
+			                      : debug_print_write(0, msg, size);
+			if((uint32_t)took != fits) res.bad_accept++;
+
+			// What _write() took is what the debugger should see. The rest
+			// is skipped in the expected stream too
+			for(int c = 0; c < took; c++)
+				debug_test_expect[debug_test_expect_head++ & (DEBUG_TEST_EXPECT - 1)] = (uint8_t)msg[c];
+
+			res.written  += len;
+			res.accepted += took;
+		}
+		else
+		{
+			uint32_t busy = host_dmdata[0] & 0x80;
+			uint32_t sent = debug_print_drain();
+			if(busy && sent) res.overwrite++;
+			if(!sent) continue;
+
+			res.packets++;
+			debug_test_inflight = sent;
+			if(sent > DEBUG_PRINT_PACKET) res.bad_packet++;
+		}
+
+		// The debugger polls the link
+		if((uint32_t)(rand() % 100) >= rate) continue;
+
+		uint32_t len = debug_test_take(packet);
+		if(len == 0) continue;
+		if(len > DEBUG_PRINT_PACKET) res.bad_packet++;
+		debug_test_inflight = 0;
+
+		for(uint32_t c = 0; c < len; c++)
+		{
+			if(debug_test_expect_tail == debug_test_expect_head
+			|| packet[c] != debug_test_expect[debug_test_expect_tail & (DEBUG_TEST_EXPECT - 1)])
+				res.bad_byte++;
+			debug_test_expect_tail++;
+		}
+		res.received += len;
+	}
+
+	// Everything not dropped is either received or still in the ring
+	if(debug_print_dropped() != (uint32_t)(res.written - res.accepted)) res.bad_dropped++;
+	if(res.accepted - res.received != debug_print_pending()
+	 + ((host_dmdata[0] & 0x80) ? (host_dmdata[0] & 0x7F) - 4 : 0)) res.bad_dropped++;
+
+	return res;
+}
+
+
+/// @brief Monotonic clock in ns
+static double debug_test_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	int fails = 0;
+
+	printf("Debug printf ring test: %d byte ring, %d byte packets, %d ops per rate\n\n",
+	       DEBUG_PRINT_RING_SIZE, DEBUG_PRINT_PACKET, DEBUG_TEST_OPS);
+
+	// No debugger attached. The status bit never clears, so the drain must
+	// send nothing and the ring keep its first DEBUG_PRINT_RING_SIZE bytes
+	debug_test_reset();
+	char msg[DEBUG_TEST_MAX_WRITE];
+	uint32_t detached_took = 0, detached_sent = 0;
+	for(uint32_t w = 0; w < 100; w++)
+	{
+		for(int c = 0; c < DEBUG_TEST_MAX_WRITE; c++) msg[c] = (char)(w * DEBUG_TEST_MAX_WRITE + c);
+		detached_took += debug_print_write(0, msg, DEBUG_TEST_MAX_WRITE);
+		detached_sent += debug_print_drain();
+	}
+	uint8_t detached_ok = (detached_took == DEBUG_PRINT_RING_SIZE && detached_sent == 0
+	                    && host_dmdata[0] == 0x80
+	                    && debug_print_pending() == DEBUG_PRINT_RING_SIZE
+	                    && debug_print_dropped() == 100 * DEBUG_TEST_MAX_WRITE - DEBUG_PRINT_RING_SIZE);
+
+	// Attaching later gets the oldest bytes, untouched
+	host_dmdata[0] = 0x00;
+	uint8_t  packet[8];
+	uint32_t got = 0;
+	while(debug_print_drain())
+	{
+		uint32_t len = debug_test_take(packet);
+		for(uint32_t c = 0; c < len; c++, got++)
+			if(packet[c] != (uint8_t)got) detached_ok = 0;
+	}
+	if(got != DEBUG_PRINT_RING_SIZE || debug_print_pending()) detached_ok = 0;
+	if(!detached_ok) fails++;
+
+	printf("Detached: took %u of %u bytes, sent %u, %u dropped, %u read on attach: %s\n\n",
+	       detached_took, 100 * DEBUG_TEST_MAX_WRITE, detached_sent,
+	       debug_print_dropped(), got, detached_ok ? "PASS" : "FAIL");
+
+	// Random writes against a debugger polling at different rates
+	printf("%-8s %12s %12s %10s %12s %10s %10s %10s %10s  %s\n",
+	       "take %", "written", "received", "dropped", "packets", "bad byte",
+	       "bad take", "bad packet", "overwrite", "result");
+
+	for(size_t r = 0; r < sizeof(debug_test_rates); r++)
+	{
+		debug_test_result_t res = debug_test_run(debug_test_rates[r]);
+
+		uint8_t ok = !res.bad_byte && !res.bad_accept && !res.bad_packet
+		          && !res.overwrite && !res.bad_dropped && res.received;
+		if(!ok) fails++;
+
+		printf("%-8u %12llu %12llu %9.2f%% %12llu %10u %10u %10u %10u  %s\n",
+		       debug_test_rates[r],
+		       (unsigned long long)res.written, (unsigned long long)res.received,
+		       100.0 * (res.written - res.accepted) / res.written,
+		       (unsigned long long)res.packets, res.bad_byte, res.bad_accept,
+		       res.bad_packet, res.overwrite, ok ? "PASS" : "FAIL");
+	}
+
+	// Cost of a 16 byte write that fits, and of a drain that finds the
+	// link busy, the most a main loop pass pays with no debugger
+	const char line[16] = "dx=12 dy=-3 w=0\n";
+	volatile uint32_t sink = 0;
+
+	debug_test_reset();
+	double start = debug_test_now_ns();
+	for(uint32_t n = 0; n < DEBUG_TEST_TIMED; n++)
+	{
+		g_dbg_tail = g_dbg_head;
+		sink += debug_print_write(0, line, sizeof(line));
+	}
+	double write_ns = (debug_test_now_ns() - start) / DEBUG_TEST_TIMED;
+
+	start = debug_test_now_ns();
+	for(uint32_t n = 0; n < DEBUG_TEST_TIMED; n++) sink += debug_print_drain();
+	double drain_ns = (debug_test_now_ns() - start) / DEBUG_TEST_TIMED;
+
+	printf("\n16 byte _write(): %.1f ns, drain with the link busy: %.1f ns\n", write_ns, drain_ns);
+
+	printf("\n%d check(s) failed\n\n", fails);
+	return fails ? 1 : 0;
+}
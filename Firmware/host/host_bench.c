@@ -0,0 +1,443 @@
+/******************************************************************************
+* Host-native benchmark for the Insomniac motion engine.
+* Builds insomniac.c for Linux against the stand-ins in this folder, and
+* polls it like a host in every row of the User Mode Registry. Reports the
+* throughput, idle time, screen edge losses and Report sizes of each mode.
+* The random modes are run again with the unbounded walk from before the
+* Virtual Cursor Box, to compare the losses. Then reports the input events
+* per hour of the Keep-Awake modes, and sweeps the
+* Stepped mode speed and the host poll interval, checking that each mode
+* keeps its speed in units per second. Ramped modes are held to the speed
+* their planned moves would average with a smooth ramp.
+*
+* Build and run with:    make host-bench
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <math.h>
+
+#include "host_firmware.h"
+
+
+/*** Benchmark Settings ******************************************************/
+#define BENCH_SECONDS     600           // Simulated time per mode
+#define BENCH_POLL_MS     USB_POLL_INTERVAL_MS  // Host poll interval, as asked
+#define BENCH_PASSES      4             // Main loop passes between polls
+#define BENCH_SEED        0x747AA32F    // Same as the lib_rand default
+#define BENCH_SCREEN_W    1920          // Simulated host screen, the cursor
+#define BENCH_SCREEN_H    1080          // starts in the middle
+#define BENCH_KEEP_SPEED  -1            // Run a mode at its own speed
+#define BENCH_PACE_ERROR  3.0           // Most % a mode may miss its speed by
+
+
+/// @brief Results of one simulated run
+typedef struct {
+	uint64_t         polls;             // IN tokens sent to endpoint 1
+	uint64_t         zero_reports;      // Reports with no movement
+	uint64_t         steps;             // Units moved, |X| + |Y|
+	uint64_t         clamped;           // Units lost to the screen edge
+	uint64_t         moves;             // Line Segments planned
+	uint32_t         high_water;        // Most Line Segments queued at once
+	uint32_t         max_report;        // Most units in one Report
+	uint32_t         max_gap;           // Most polls between moving Reports
+	uint32_t         max_change;        // Largest change in units between Reports
+	uint32_t         max_peak;          // Fastest Line Segment, Q16.16
+	uint32_t         max_accel;         // Steepest Line Segment ramp, Q16.16
+	uint64_t         planned_steps;     // Units planned in Line Segments
+	double           planned_s;         // Time they take with a smooth ramp
+	uint32_t         max_offset;        // Furthest from the start, either axis
+	uint32_t         drift;             // Units from the start at the end
+	uint16_t         directions;        // Bit per X and Y sign of moving Reports
+	uint64_t         wheel_ticks;       // Wheel ticks scrolled, either way
+	int32_t          wheel_net;         // Wheel ticks from the start at the end
+	double           host_ns;           // Wall time spent in firmware code
+} bench_result_t;
+
+
+
+/// @brief Stepped mode speeds to sweep, units per second
+static const uint16_t bench_speeds[] = {
+	1, 3, 10, 30, 50, 75, 100,
+};
+
+
+/// @brief Host poll intervals to sweep, ms
+static const uint8_t bench_polls[] = {
+	1, 2, 4, 8, 10, 16, 32,
+};
+
+
+// A registry row with the speed overridden
+static user_mode_desc_t bench_mode;
+
+// Planner to run instead of the mode's own, NULL for its own
+static void (*bench_plan)(void);
+
+
+
+/*** Simulation **************************************************************/
+/// @brief Seconds a move takes with a smooth ramp, up to the mode's speed
+/// and back down. Moves too short to reach it turn back half way
+static double bench_ramp_time(const uint32_t steps)
+{
+	double speed = g_mode->speed;
+	double ramp  = g_mode->ramp_ms / 1000.0;
+
+	if(steps >= speed * ramp) return steps / speed + ramp;
+	return 2.0 * sqrt(steps * ramp / speed);
+}
+
+
+/// @brief Units per second a mode should move at. Ramped modes spend part
+/// of each move speeding up and slowing down
+static double bench_target(const bench_result_t *res)
+{
+	if(g_mode->ramp_ms && res->planned_s) return res->planned_steps / res->planned_s;
+	return g_mode->speed;
+}
+
+
+/// @brief Runs one mode for BENCH_SECONDS of simulated time. The main loop
+/// gets BENCH_PASSES passes between each poll from the host. The speed overrides the
+/// mode's own, unless it is BENCH_KEEP_SPEED
+static bench_result_t bench_run(const user_mode_t mode, const int32_t speed,
+                                const uint32_t poll_ms)
+{
+	bench_result_t res = {0};
+	host_firmware_reset(mode, BENCH_SEED);
+	if(bench_plan) g_plan = bench_plan;
+	if(speed != BENCH_KEEP_SPEED)
+	{
+		bench_mode       = g_user_modes[mode];
+		bench_mode.speed = (uint16_t)speed;
+		g_mode           = &bench_mode;
+		pacing_scale();
+	}
+
+	uint32_t gap = 0, last_units = 0;
+
+	// Where the host OS thinks the cursor is
+	int32_t screen_x = BENCH_SCREEN_W / 2;
+	int32_t screen_y = BENCH_SCREEN_H / 2;
+
+	const uint64_t polls = (uint64_t)BENCH_SECONDS * 1000 / poll_ms;
+	for(uint64_t p = 0; p < polls; p++)
+	{
+		double start = host_now_ns();
+
+		// Main loop passes, count any new lines they planned
+		for(uint32_t pass = 0; pass < BENCH_PASSES; pass++)
+		{
+			uint32_t head = g_mi_buffer_head;
+			motion_task();
+			res.moves += (g_mi_buffer_head - head) & (MI_BUFFER_SIZE - 1);
+
+			for(uint32_t s = head; s != g_mi_buffer_head; s = (s + 1) & (MI_BUFFER_SIZE - 1))
+			{
+				res.planned_steps += g_mi_buffer[s].steps;
+				if(g_mode->ramp_ms) res.planned_s += bench_ramp_time(g_mi_buffer[s].steps);
+			}
+
+			// The Line Segment being profiled, if it is still moving
+			if(g_profile.peak > res.max_peak)   res.max_peak  = g_profile.peak;
+			if(g_profile.accel > res.max_accel) res.max_accel = g_profile.accel;
+
+			uint32_t queued = mi_buffer_count();
+			if(queued > res.high_water) res.high_water = queued;
+		}
+
+		// Host polls the mouse endpoint
+		host_packet_len = 0;
+		usb_handle_user_in_request(NULL, NULL, 1, 0, NULL);
+
+		res.host_ns += host_now_ns() - start;
+		res.polls++;
+
+		// Decode the report the host received
+		int8_t dx = (host_packet_len >= 3) ? (int8_t)host_packet[1] : 0;
+		int8_t dy = (host_packet_len >= 3) ? (int8_t)host_packet[2] : 0;
+		int8_t dw = (host_packet_len >= 4) ? (int8_t)host_packet[3] : 0;
+
+		res.wheel_ticks += int_abs(dw);
+		res.wheel_net   += dw;
+
+		uint32_t units = int_abs(dx) + int_abs(dy);
+		if(units) res.directions |= 1 << (((dx > 0) - (dx < 0) + 1) * 3 + (dy > 0) - (dy < 0) + 1);
+		if(units == 0 && dw == 0)
+		{
+			res.zero_reports++;
+			gap++;
+		}
+		else
+		{
+			if(gap > res.max_gap) res.max_gap = gap;
+			gap = 0;
+		}
+		if(units > res.max_report) res.max_report = units;
+		uint32_t change = int_abs((int32_t)units - (int32_t)last_units);
+		if(change > res.max_change) res.max_change = change;
+		last_units = units;
+		res.steps += units;
+
+		// Move the host cursor, clamping at the screen edges like an OS does
+		int32_t new_x = screen_x + dx;
+		int32_t new_y = screen_y + dy;
+		if(new_x < 0) new_x = 0;
+		if(new_y < 0) new_y = 0;
+		if(new_x > BENCH_SCREEN_W - 1) new_x = BENCH_SCREEN_W - 1;
+		if(new_y > BENCH_SCREEN_H - 1) new_y = BENCH_SCREEN_H - 1;
+
+		res.clamped += (int_abs(dx) - int_abs(new_x - screen_x))
+		             + (int_abs(dy) - int_abs(new_y - screen_y));
+		screen_x = new_x;
+		screen_y = new_y;
+
+		uint32_t offset_x = int_abs(screen_x - BENCH_SCREEN_W / 2);
+		uint32_t offset_y = int_abs(screen_y - BENCH_SCREEN_H / 2);
+		if(offset_x > res.max_offset) res.max_offset = offset_x;
+		if(offset_y > res.max_offset) res.max_offset = offset_y;
+
+		DelaySysTick(Ticks_from_Ms(poll_ms));
+	}
+
+	res.drift = int_abs(screen_x - BENCH_SCREEN_W / 2) + int_abs(screen_y - BENCH_SCREEN_H / 2);
+
+	return res;
+}
+
+
+
+/// @brief The random planner from before the Virtual Cursor Box. Each
+/// endpoint is a random offset from wherever the last one left the cursor,
+/// so it wanders into a screen edge and the host clamps the moves past it
+static void bench_plan_unbounded(void)
+{
+	position_t rand_pos = {.x = int_rand(g_mode->range), .y = int_rand(g_mode->range)};
+	move_to_endpoint(rand_pos);
+}
+
+
+/// @brief Misses a run of polls in the Stepped mode, as if the main loop had
+/// stalled. The Accumulator must come back holding exactly one poll's worth
+/// of whole steps, however long the stall
+/// @param Speed to run at, units per second
+/// @return 1 if every stall filled the Accumulator without wrapping
+static uint8_t bench_stall(const uint16_t speed)
+{
+	static const uint32_t stalls[] = {65537, 1000000, 0x7FFFFFFF};
+
+	host_firmware_reset(USER_MODE_STEPPED, BENCH_SEED);
+	bench_mode       = g_user_modes[USER_MODE_STEPPED];
+	bench_mode.speed = speed;
+	g_mode           = &bench_mode;
+	pacing_scale();
+
+	for(size_t s = 0; s < sizeof(stalls) / sizeof(stalls[0]); s++)
+	{
+		g_velocity_acc = 0;
+		g_poll_count  += stalls[s];
+		velocity_update();
+		if(g_velocity_acc != g_velocity + (VELOCITY_ONE - 1)) return 0;
+	}
+
+	return 1;
+}
+
+
+/// @brief Sends a Line Segment that is already on the last level of its
+/// profile, as a short fast one can be. It must go out in full Reports, with
+/// the rest carried to the next, whatever its length
+/// @param Steps in the Line Segment
+/// @return Reports it took, 0 if any steps were lost or a Report was too big
+static uint32_t bench_last_level(const int16_t steps)
+{
+	host_firmware_reset(USER_MODE_NORMAL, BENCH_SEED);
+	move_to_endpoint((position_t){steps / 2, steps - steps / 2});
+	g_profile = (profile_t){.peak = VELOCITY_ONE, .accel = VELOCITY_ONE,
+	                        .levels = 1, .braking = 0x01};
+
+	uint32_t reports = 0, sent = 0;
+	uint8_t report[REPORT_SIZE];
+	while(mi_buffer_count() && reports <= (uint32_t)steps)
+	{
+		report[0] = 0x00;  report[1] = 0x00;  report[2] = 0x00;  report[3] = 0x00;
+		compose_report(report);
+		uint32_t units = int_abs((int8_t)report[1]) + int_abs((int8_t)report[2]);
+		if(units > REPORT_STEP_LIMIT) return 0;
+		sent += units;
+		reports++;
+	}
+
+	return (sent == (uint32_t)steps) ? reports : 0;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	printf("Insomniac host benchmark: %d s simulated per mode, %d ms polls\n\n",
+	       BENCH_SECONDS, BENCH_POLL_MS);
+	printf("%-10s %10s %14s %12s %14s %10s %8s %8s %10s %10s\n",
+	       "Mode", "steps/s", "reports/move", "high-water", "zero-reports",
+	       "clamped", "peak", "change", "events/h", "ns/poll");
+
+	int fails = 0;
+	for(uint8_t m = 0; m < USER_MODE_COUNT; m++)
+	{
+		bench_result_t res = bench_run((user_mode_t)m, BENCH_KEEP_SPEED, BENCH_POLL_MS);
+
+		// Every mode must keep the cursor, or the wheel, moving
+		if(res.steps == 0 && res.wheel_ticks == 0) fails++;
+
+		uint64_t moving = res.polls - res.zero_reports;
+
+		// Profiled modes must ramp one accel step at a time, up to the peak
+		// of each Line Segment. Both are fractions of a step, and the carry
+		// can hold back one step of a Report
+		if(g_profile_peak
+		&& (res.max_change > ((res.max_accel + 0xFFFF) >> 16) + 1
+		 || res.max_report > ((res.max_peak + 0xFFFF) >> 16))) fails++;
+
+		printf("%-10s %10.1f %14.2f %12u %13.2f%% %9.2f%% %8u %8u %10.0f %10.1f\n",
+		       host_mode_names[m],
+		       (double)res.steps / BENCH_SECONDS,
+		       res.moves ? (double)moving / res.moves : 0.0,
+		       res.high_water,
+		       100.0 * res.zero_reports / res.polls,
+		       res.steps ? 100.0 * res.clamped / res.steps : 0.0,
+		       res.max_report, res.max_change,
+		       3600.0 * moving / BENCH_SECONDS,
+		       res.host_ns / res.polls);
+	}
+	printf("\nEvery mode moves, Acceleration Profile: %s\n", fails ? "FAIL" : "PASS");
+
+	// Longer than a Report on its last level, including 256 steps, which a
+	// uint8_t count would see as none
+	static const int16_t last_steps[] = {100, 127, 200, 256, 300, 600};
+	uint8_t last_ok = 1;
+	for(size_t l = 0; l < sizeof(last_steps) / sizeof(last_steps[0]); l++)
+	{
+		uint32_t took = bench_last_level(last_steps[l]);
+		uint32_t need = (last_steps[l] + REPORT_STEP_LIMIT - 1) / REPORT_STEP_LIMIT;
+		if(took != need) last_ok = 0;
+	}
+	if(!last_ok) fails++;
+	printf("Last profile level longer than a Report: %s\n", last_ok ? "PASS" : "FAIL");
+
+	uint8_t stall_ok = bench_stall(1) && bench_stall(STEPPED_SPEED) && bench_stall(PACE_MAX_SPEED);
+	if(!stall_ok) fails++;
+	printf("Velocity Accumulator after a stall of up to 2^31 polls: %s\n",
+	       stall_ok ? "PASS" : "FAIL");
+
+	// Screen edge clamping of the random modes, with the planner from before
+	// the Virtual Cursor Box and with the mode's own. The box must keep
+	// every step on the screen
+	printf("\nSteps lost to the screen edge, unbounded walk and Virtual Cursor Box\n\n");
+	printf("%-10s %10s %10s  %s\n", "Mode", "before", "after", "result");
+	for(uint8_t m = 0; m < USER_MODE_COUNT; m++)
+	{
+		if(g_user_modes[m].plan != USER_MODE_PLAN_RANDOM
+		&& g_user_modes[m].plan != USER_MODE_PLAN_COVER) continue;
+
+		bench_plan = bench_plan_unbounded;
+		bench_result_t before = bench_run((user_mode_t)m, BENCH_KEEP_SPEED, BENCH_POLL_MS);
+		bench_plan = NULL;
+		bench_result_t after  = bench_run((user_mode_t)m, BENCH_KEEP_SPEED, BENCH_POLL_MS);
+
+		uint8_t ok = (after.clamped == 0);
+		if(!ok) fails++;
+		printf("%-10s %9.2f%% %9.2f%%  %s\n", host_mode_names[m],
+		       before.steps ? 100.0 * before.clamped / before.steps : 0.0,
+		       after.steps ? 100.0 * after.clamped / after.steps : 0.0,
+		       ok ? "PASS" : "FAIL");
+	}
+
+	// Keep-Awake mode must send one out and one back Report per period, and
+	// leave the cursor, and the Virtual Cursor, where they started. Each
+	// nudge picks a new angle, so more than the two ways along one axis
+	bench_result_t awake = bench_run(USER_MODE_KEEP_AWAKE, BENCH_KEEP_SPEED, BENCH_POLL_MS);
+	uint64_t awake_events = awake.polls - awake.zero_reports;
+	uint32_t awake_dirs   = __builtin_popcount(awake.directions);
+	// The first nudge is a whole period after power-on, and one due as the
+	// run ends isn't seen
+	uint64_t awake_expect = 2 * ((BENCH_SECONDS - 1) / KEEP_AWAKE_PERIOD_S);
+	uint8_t awake_ok = (awake_events == awake_expect && awake.drift == 0
+	                 && awake.max_offset <= KEEP_AWAKE_NUDGE && awake_dirs > 2
+	                 && g_cursor.x == 0 && g_cursor.y == 0);
+	if(!awake_ok) fails++;
+
+	printf("\nKeep-Awake every %d s: %.0f input events per hour (%llu expected in %d s),"
+	       " %.4f%% of polls, %u unit(s) drift, %u direction(s): %s\n",
+	       KEEP_AWAKE_PERIOD_S, 3600.0 * awake_events / BENCH_SECONDS,
+	       (unsigned long long)awake_expect, BENCH_SECONDS,
+	       100.0 * awake_events / awake.polls, awake.drift, awake_dirs,
+	       awake_ok ? "PASS" : "FAIL");
+
+	// Wheel mode the same, one tick out and back, with the pointer still
+	bench_result_t wheel = bench_run(USER_MODE_WHEEL, BENCH_KEEP_SPEED, BENCH_POLL_MS);
+	uint64_t wheel_events = wheel.polls - wheel.zero_reports;
+	uint64_t wheel_expect = 2 * WHEEL_NUDGE * ((BENCH_SECONDS - 1) / KEEP_AWAKE_PERIOD_S);
+	uint8_t wheel_ok = (wheel_events == wheel_expect && wheel.wheel_net == 0
+	                 && wheel.steps == 0);
+	if(!wheel_ok) fails++;
+
+	printf("Wheel every %d s: %.0f input events per hour (%llu expected in %d s),"
+	       " %llu tick(s) scrolled, %d net, %llu pointer unit(s): %s\n",
+	       KEEP_AWAKE_PERIOD_S, 3600.0 * wheel_events / BENCH_SECONDS,
+	       (unsigned long long)wheel_expect, BENCH_SECONDS,
+	       (unsigned long long)wheel.wheel_ticks, wheel.wheel_net,
+	       (unsigned long long)wheel.steps, wheel_ok ? "PASS" : "FAIL");
+
+	// Speed sweep. Each Mouse Instruction is one unit on one axis, so the
+	// units per Report should average the speed times the poll interval
+	printf("\nStepped mode speed sweep\n\n");
+	printf("%-10s %14s %14s %10s %12s %10s\n",
+	       "units/s", "target/report", "actual/report", "error", "max/report", "max gap");
+
+	for(size_t v = 0; v < sizeof(bench_speeds) / sizeof(bench_speeds[0]); v++)
+	{
+		bench_result_t res = bench_run(USER_MODE_STEPPED, bench_speeds[v], BENCH_POLL_MS);
+
+		double target = bench_speeds[v] * BENCH_POLL_MS / 1000.0;
+		double actual = (double)res.steps / res.polls;
+		double error  = 100.0 * (actual - target) / target;
+
+		// Never more whole steps in a Report than the speed needs
+		uint32_t limit = (uint32_t)(target + 0.999);
+		if(error < -1.0 || error > 1.0 || res.max_report > limit) fails++;
+
+		printf("%-10u %14.5f %14.5f %9.2f%% %12u %10u\n",
+		       bench_speeds[v], target, actual, error, res.max_report, res.max_gap);
+	}
+
+	// Poll interval sweep. Every mode must move at its speed in units per
+	// second whatever interval the host polls at. Modes with no speed are
+	// only printed
+	printf("\nPoll interval sweep, units per second (error from the target)\n\n");
+	printf("%-10s %6s %8s", "Mode", "speed", "target");
+	for(size_t p = 0; p < sizeof(bench_polls); p++) printf(" %12u ms", bench_polls[p]);
+	printf("\n");
+
+	for(uint8_t m = 0; m < USER_MODE_COUNT; m++)
+	{
+		bench_result_t base = bench_run((user_mode_t)m, BENCH_KEEP_SPEED, BENCH_POLL_MS);
+		double target = bench_target(&base);
+
+		printf("%-10s %6u %8.1f", host_mode_names[m], g_mode->speed, target);
+		for(size_t p = 0; p < sizeof(bench_polls); p++)
+		{
+			bench_result_t res = bench_run((user_mode_t)m, BENCH_KEEP_SPEED, bench_polls[p]);
+			double speed = (double)res.steps / BENCH_SECONDS;
+			double error = target ? 100.0 * (speed - target) / target : 0.0;
+
+			if(error < -BENCH_PACE_ERROR || error > BENCH_PACE_ERROR) fails++;
+			printf(" %7.1f %+5.1f%%", speed, error);
+		}
+		printf("\n");
+	}
+
+	printf("\nSpeed and poll interval sweeps: %s\n\n", fails ? "FAIL" : "PASS");
+	return fails ? 1 : 0;
+}
@@ -0,0 +1,79 @@
+/******************************************************************************
+* Shared by the host tools that build insomniac.c, include it in place of the
+* firmware source. Pulls in the firmware as-is with main() renamed, so the
+* tool owns it, then puts the firmware back into its power-on state in any
+* mode, names the rows of the User Mode Registry, and times the host side.
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#ifndef INSOMNIAC_HOST_FIRMWARE_H
+#define INSOMNIAC_HOST_FIRMWARE_H
+
+#include <stdlib.h>
+#include <time.h>
+
+// lib_rand defines its own rand(), hide the stdlib one
+#define rand insomniac_rand
+#define main insomniac_main
+#include "insomniac.c"
+#undef main
+
+
+/// @brief Returns a monotonic wall clock in nanoseconds
+static inline double host_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+
+/// @brief Name of every mode in the registry, in jumper order
+#define HOST_MODE_NAME(name, jumpers, range, speed, ramp, cap, plan) \
+	[jumpers] = #name,
+__attribute__((unused))
+static const char *host_mode_names[USER_MODE_COUNT] = {
+	USER_MODE_LIST(HOST_MODE_NAME)
+};
+#undef HOST_MODE_NAME
+
+
+/// @brief Puts the firmware into its power-on state in a mode, as if the
+/// jumpers had just been read. The SysTick starts from 0, and the simulated
+/// host from DATA0
+/// @param Mode to run
+/// @param lib_rand seed
+/// @return None
+static inline void host_firmware_reset(const user_mode_t mode, const uint32_t rand_seed)
+{
+	// Mouse Instruction Buffer and Report Mailbox
+	g_mi_buffer_head   = 0;
+	g_mi_buffer_tail   = 0;
+	g_report_full[0]   = 0x00;
+	g_report_full[1]   = 0x00;
+	g_report_read      = 0;
+	g_report_write     = 0;
+
+	// Poll counting and Pacing, back to the asked for bInterval
+	g_poll_count       = 0;
+	g_poll_seen        = 0;
+	g_poll_tick        = 0;
+	g_poll_last_tick   = 0;
+	g_poll_period      = Ticks_from_Ms(USB_POLL_INTERVAL_MS);
+
+	// Planners
+	g_cursor           = (position_t){0, 0};
+	g_pattern          = (pattern_t){0};
+	g_pattern_next     = 0;
+
+	host_systick.CNT   = 0;
+	host_expect_pid    = HOST_PID_DATA0;
+	host_toggle_errors = 0;
+
+	// Sets up the rest from the mode's row
+	g_user_mode        = mode;
+	user_mode_setup();
+	seed(rand_seed);
+}
+
+#endif
@@ -0,0 +1,69 @@
+/******************************************************************************
+* Host stand-ins for the hardware used by insomniac.c - Shared by the host
+* tools. Registers are plain variables, delays advance the simulated SysTick
+* and USB packets are captured for the simulated host to read back.
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include "ch32v003fun.h"
+#include "rv003usb.h"
+
+#include <string.h>
+
+
+/*** Registers ***************************************************************/
+GPIO_TypeDef  host_gpioa;
+GPIO_TypeDef  host_gpioc;
+RCC_TypeDef   host_rcc;
+SysTick_Type  host_systick;
+
+
+/*** USB *********************************************************************/
+uint8_t   host_packet[8];
+uint32_t  host_packet_len;
+uint8_t   host_packet_pid;
+uint8_t   host_expect_pid = HOST_PID_DATA0;
+uint32_t  host_toggle_errors;
+
+
+
+/*** Functions ***************************************************************/
+void DelaySysTick(uint32_t n)
+{
+	host_systick.CNT += n;
+}
+
+
+void SystemInit(void) {}
+void usb_setup() {}
+void set_usb_serial_uuid(void) {}
+uint32_t debug_print_drain(void) { return 0; }
+
+
+void usb_send_data(const void *data, uint32_t length, uint32_t poly_function, uint32_t token)
+{
+	(void)poly_function;
+
+	if(length > sizeof(host_packet)) length = sizeof(host_packet);
+	memcpy(host_packet, data, length);
+	host_packet_len = length;
+	host_packet_pid = (uint8_t)token;
+
+	// The host ACKs the packet, and wants the other PID next time
+	if(host_packet_pid != host_expect_pid) host_toggle_errors++;
+	host_expect_pid = (host_expect_pid == HOST_PID_DATA0) ? HOST_PID_DATA1 : HOST_PID_DATA0;
+}
+
+
+void usb_send_empty(uint32_t token)
+{
+	host_packet_len = 0;
+	host_packet_pid = (uint8_t)token;
+}
+
+
+void usb_send_nak(void)
+{
+	host_packet_len = 0;
+	host_packet_pid = HOST_PID_NAK;
+}
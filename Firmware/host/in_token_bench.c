@@ -0,0 +1,314 @@
+/******************************************************************************
+* Host benchmark of the work done per IN token on the mouse endpoint, before
+* and after Reports were composed ahead of time into the double-buffered
+* Report Mailbox.
+* Before, the USB Interrupt popped and peeked the Mouse Instruction Buffer and
+* merged diagonals itself, that handler is kept here as the baseline. After,
+* it only sends a Mailbox slot. Every mode is run both ways, counting the
+* Mouse Instructions each handler takes from the buffer, and the same
+* operations in each handler - buffer calls, which expand a Line Segment
+* step, flags and statuses branched on, SysTick reads and bytes copied into
+* the USB packet. The Mailbox handler is counted on a copy of the firmware's,
+* which is checked against the real one on every token.
+*
+* Build and run with:    make host-in
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "host_firmware.h"
+
+
+/*** Bench Settings **********************************************************/
+#define IN_TOKENS            200000     // IN tokens per mode and handler
+#define IN_PASSES            4          // Main loop passes between tokens
+#define IN_SEED              0x747AA32F
+
+
+/// @brief Per-token work of one handler over one run
+typedef struct {
+	uint32_t         tokens;
+	uint32_t         moving;            // Tokens answered with movement
+	uint64_t         taken;             // Mouse Instructions taken in handler
+	uint32_t         taken_max;
+	uint64_t         calls;             // Buffer calls made in handler
+	uint64_t         checks;            // Flags and statuses branched on
+	uint64_t         ticks;             // SysTick reads
+	uint64_t         copied;            // Bytes copied into the USB packet
+	uint32_t         differed;          // Tokens the copy didn't match
+} in_result_t;
+
+
+/// @brief Operations one handler call made, counted the same way in both
+typedef struct {
+	uint32_t         calls;
+	uint32_t         checks;
+	uint32_t         ticks;
+	uint32_t         copied;
+} in_ops_t;
+
+/// @brief What a handler call leaves behind, to compare the counted Mailbox
+/// handler with the firmware's
+typedef struct {
+	uint32_t         packet_len;
+	uint32_t         poll_count;
+	uint32_t         poll_tick;
+	uint32_t         toggle_errors;
+	uint8_t          packet[8];
+	uint8_t          packet_pid;
+	uint8_t          expect_pid;
+	uint8_t          full[2];
+	uint8_t          read;
+} in_state_t;
+
+
+static in_ops_t  in_ops;
+
+// Count an operation as it runs, and give back its value
+#define IN_CALL(call)     (in_ops.calls++,  (call))
+#define IN_CHECK(cond)    (in_ops.checks++, (cond))
+#define IN_TICK()         (in_ops.ticks++,  SysTick->CNT)
+
+
+
+/*** Helpers *****************************************************************/
+/// @brief Counts the Mouse Instructions left in the buffer
+static uint32_t in_queued(void)
+{
+	uint32_t steps = 0;
+	for(uint32_t s = g_mi_buffer_tail; s != g_mi_buffer_head; s = (s + 1) & (MI_BUFFER_SIZE - 1))
+		steps += g_mi_buffer[s].steps;
+	return steps;
+}
+
+
+/// @brief Sends a packet like usb_send_data(), counting the bytes copied
+static void in_send_data(const uint8_t *data, const uint32_t length, const uint32_t sendtok)
+{
+	in_ops.copied += length;
+	usb_send_data(data, length, 0, sendtok);
+}
+
+
+/// @brief Snapshots everything a handler call can change
+static in_state_t in_state_save(void)
+{
+	in_state_t state;
+	memset(&state, 0x00, sizeof(state));
+
+	state.packet_len    = host_packet_len;
+	state.poll_count    = g_poll_count;
+	state.poll_tick     = g_poll_tick;
+	state.toggle_errors = host_toggle_errors;
+	memcpy(state.packet, host_packet, sizeof(state.packet));
+	state.packet_pid    = host_packet_pid;
+	state.expect_pid    = host_expect_pid;
+	state.full[0]       = g_report_full[0];
+	state.full[1]       = g_report_full[1];
+	state.read          = g_report_read;
+	return state;
+}
+
+
+/// @brief Puts back a snapshot from in_state_save()
+static void in_state_load(const in_state_t *state)
+{
+	host_packet_len    = state->packet_len;
+	g_poll_count       = state->poll_count;
+	g_poll_tick        = state->poll_tick;
+	host_toggle_errors = state->toggle_errors;
+	memcpy(host_packet, state->packet, sizeof(state->packet));
+	host_packet_pid    = state->packet_pid;
+	host_expect_pid    = state->expect_pid;
+	g_report_full[0]   = state->full[0];
+	g_report_full[1]   = state->full[1];
+	g_report_read      = state->read;
+}
+
+
+/// @brief Adds one handler call to the totals
+static void in_count(in_result_t *res, const uint32_t taken, const in_ops_t *ops)
+{
+	res->tokens++;
+	res->taken += taken;
+	if(taken > res->taken_max) res->taken_max = taken;
+	res->calls  += ops->calls;
+	res->checks += ops->checks;
+	res->ticks  += ops->ticks;
+	res->copied += ops->copied;
+
+	if(host_packet_len == REPORT_SIZE && (host_packet[1] || host_packet[2] || host_packet[3]))
+		res->moving++;
+}
+
+
+
+/*** Baseline ****************************************************************/
+/// @brief Adds a Mouse Instruction to a Report, like set_mouse_instr_bytes()
+static void in_set_bytes(uint8_t *buffer, const mouse_instr_t instr)
+{
+	position_t step = mouse_instr_delta(instr);
+	buffer[1] |= (uint8_t)step.x;
+	buffer[2] |= (uint8_t)step.y;
+	buffer[3] |= (uint8_t)mouse_instr_wheel(instr);
+}
+
+
+/// @brief The mouse endpoint handler from before the Report Mailbox. Composes
+/// the Report inside the Interrupt - one instruction, and a second if the
+/// two make a diagonal
+static void in_baseline_handler(const uint32_t sendtok)
+{
+	uint8_t mouse_bytes[4] = {0x00, 0x00, 0x00, 0x00};
+	mouse_instr_t crnt_mouse_instr, next_mouse_instr;
+
+	mi_buffer_status_t crnt_buffer_status = IN_CALL(mi_buffer_pop(&crnt_mouse_instr));
+	mi_buffer_status_t next_buffer_status = IN_CALL(mi_buffer_peek(&next_mouse_instr));
+
+	if(IN_CHECK(crnt_buffer_status == MI_BUFFER_OK))
+		in_set_bytes(mouse_bytes, crnt_mouse_instr);
+
+	if(IN_CHECK(next_buffer_status == MI_BUFFER_OK))
+	{
+		if(IN_CHECK((next_mouse_instr == MOUSE_INSTR_L || next_mouse_instr == MOUSE_INSTR_R)
+		         && (crnt_mouse_instr == MOUSE_INSTR_U || crnt_mouse_instr == MOUSE_INSTR_D)))
+		{
+			in_set_bytes(mouse_bytes, next_mouse_instr);
+			IN_CALL(mi_buffer_skip());
+		}
+
+		if(IN_CHECK((next_mouse_instr == MOUSE_INSTR_U || next_mouse_instr == MOUSE_INSTR_D)
+		         && (crnt_mouse_instr == MOUSE_INSTR_L || crnt_mouse_instr == MOUSE_INSTR_R)))
+		{
+			in_set_bytes(mouse_bytes, next_mouse_instr);
+			IN_CALL(mi_buffer_skip());
+		}
+	}
+
+	in_send_data(mouse_bytes, 4, sendtok);
+}
+
+
+
+/*** Report Mailbox **********************************************************/
+/// @brief The mouse endpoint of usb_handle_user_in_request(), line for line,
+/// with the same operations counted as in the baseline
+static void in_mailbox_handler(const uint32_t sendtok)
+{
+	uint8_t slot = g_report_read;
+	g_poll_tick = IN_TICK();
+	g_poll_count++;
+
+	if(IN_CHECK(g_report_full[slot]))
+	{
+		if(USB_IDLE_NAK && IN_CHECK(g_report_full[slot] == REPORT_SLOT_HOLD)) usb_send_nak();
+		else in_send_data(g_report_mailbox[slot], REPORT_SIZE, sendtok);
+
+		g_report_full[slot] = 0x00;
+		g_report_read       = slot ^ 0x01;
+	}
+	else
+	{
+#if USB_IDLE_NAK
+		usb_send_nak();
+#else
+		in_send_data(g_report_idle, REPORT_SIZE, sendtok);
+#endif
+	}
+}
+
+
+/// @brief Runs the counted copy, then the firmware's handler from the same
+/// state, so the counts are for the path the firmware really takes
+/// @param IN token PID
+/// @return 1 if both sent the same packet and left the same state
+static uint8_t in_mailbox_token(const uint32_t sendtok)
+{
+	in_state_t before = in_state_save();
+	in_mailbox_handler(sendtok);
+	in_state_t counted = in_state_save();
+
+	in_state_load(&before);
+	usb_handle_user_in_request(NULL, NULL, 1, sendtok, NULL);
+	in_state_t firmware = in_state_save();
+
+	return memcmp(&counted, &firmware, sizeof(in_state_t)) == 0;
+}
+
+
+
+/*** Simulation **************************************************************/
+/// @brief Runs one mode with either handler. The main loop only plans when
+/// the baseline runs, as it had no Mailbox to fill
+/// @param Mode to run
+/// @param 1 for the baseline handler, 0 for the Mailbox one
+/// @return Totals from the run
+static in_result_t in_run(const user_mode_t mode, const uint8_t baseline)
+{
+	in_result_t res = {0};
+	host_firmware_reset(mode, IN_SEED);
+
+	for(uint32_t t = 0; t < IN_TOKENS; t++)
+	{
+		for(uint32_t pass = 0; pass < IN_PASSES; pass++)
+		{
+			if(!baseline)                                     motion_task();
+			else if(mi_buffer_count() < MI_BUFFER_LOW_WATER)  g_plan();
+		}
+
+		uint32_t sendtok = host_expect_pid;
+		host_packet_len = 0;
+		uint32_t queued = in_queued();
+		in_ops = (in_ops_t){0};
+
+		if(baseline)                         in_baseline_handler(sendtok);
+		else if(!in_mailbox_token(sendtok))  res.differed++;
+
+		in_count(&res, queued - in_queued(), &in_ops);
+		DelaySysTick(Ticks_from_Ms(USB_POLL_INTERVAL_MS));
+	}
+
+	return res;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	int fails = 0;
+
+	printf("IN token work: %d tokens per mode, %d ms polls, operations per token\n\n",
+	       IN_TOKENS, USB_POLL_INTERVAL_MS);
+	printf("%-10s %-9s %8s %12s %10s %8s %8s %8s %8s  %s\n",
+	       "Mode", "handler", "moving", "taken/token", "taken max",
+	       "calls", "checks", "ticks", "copied", "result");
+
+	for(uint8_t m = 0; m < USER_MODE_COUNT; m++)
+	{
+		// The baseline first, then the Mailbox
+		for(uint8_t run = 0; run < 2; run++)
+		{
+			uint8_t baseline = (run == 0);
+			in_result_t res = in_run((user_mode_t)m, baseline);
+
+			// The Mailbox handler must never touch the Mouse Instruction
+			// Buffer, and its counted copy must match the firmware's
+			uint8_t ok = baseline || (res.taken == 0 && res.differed == 0);
+			if(!ok) fails++;
+
+			printf("%-10s %-9s %8u %12.2f %10u %8.2f %8.2f %8.2f %8.2f  %s\n",
+			       baseline ? host_mode_names[m] : "",
+			       baseline ? "before" : "mailbox",
+			       res.moving, (double)res.taken / res.tokens, res.taken_max,
+			       (double)res.calls / res.tokens, (double)res.checks / res.tokens,
+			       (double)res.ticks / res.tokens, (double)res.copied / res.tokens,
+			       baseline ? "" : (ok ? "PASS" : "FAIL"));
+		}
+	}
+
+	printf("\n%d mode(s) failed\n\n", fails);
+	return fails ? 1 : 0;
+}
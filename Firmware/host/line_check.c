@@ -0,0 +1,154 @@
+/******************************************************************************
+* Host check of the Line Segment queue against the per-step Bresenham loop it
+* replaced. Sweeps endpoints over every direction, densely near the origin
+* and coarsely out to the far corners of the Virtual Cursor Box. Each line is
+* queued with move_to_endpoint() and expanded with mi_buffer_pop(), and the
+* Mouse Instructions must match the baseline loop one for one.
+*
+* Build and run with:    make host-line
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+
+#include "host_firmware.h"
+
+
+/*** Check Settings **********************************************************/
+#define LINE_DENSE           48         // Every endpoint within this square
+#define LINE_COARSE_X        (2 * CURSOR_BOUND_X)
+#define LINE_COARSE_Y        (2 * CURSOR_BOUND_Y)
+#define LINE_COARSE_STEP_X   23         // Coarse sweep spacing, co-prime with
+#define LINE_COARSE_STEP_Y   17         // the box, so lines land off the axes
+#define LINE_MAX_STEPS       (LINE_COARSE_X + LINE_COARSE_Y)
+
+
+static mouse_instr_t  base_instr[LINE_MAX_STEPS];
+static mouse_instr_t  seg_instr[LINE_MAX_STEPS];
+
+
+
+/*** Baseline ****************************************************************/
+/// @brief The per-step Bresenham loop from before Line Segments were queued,
+/// writing each instruction it pushed to an array instead of the buffer
+/// @param endpoint to move to from the origin
+/// @param Array to write the Mouse Instructions to
+/// @return Number of Mouse Instructions written
+static uint32_t base_line(const position_t endpoint, mouse_instr_t *out)
+{
+	uint32_t count = 0;
+	position_t startpoint = {0, 0};
+
+	int32_t x_delta = int_abs(endpoint.x - startpoint.x);
+	int32_t y_delta = int_abs(endpoint.y - startpoint.y);
+	int32_t x_step = (startpoint.x < endpoint.x)  ?  1 : -1;
+	int32_t y_step = (startpoint.y < endpoint.y)  ?  1 : -1;
+	int32_t err = x_delta - y_delta;
+
+	while(startpoint.x != endpoint.x || startpoint.y != endpoint.y)
+	{
+		int32_t err2 = err * 2;
+
+		if(err2 > -y_delta)
+		{
+			err -= y_delta;
+			startpoint.x += x_step;
+			out[count++] = (x_step > 0) ? MOUSE_INSTR_R : MOUSE_INSTR_L;
+		}
+
+		if(err2 < x_delta)
+		{
+			err += x_delta;
+			startpoint.y += y_step;
+			out[count++] = (y_step > 0) ? MOUSE_INSTR_U : MOUSE_INSTR_D;
+		}
+	}
+
+	return count;
+}
+
+
+
+/*** Checks ******************************************************************/
+/// @brief Queues one line and expands it, comparing it to the baseline
+/// @param endpoint to move to from the origin
+/// @return 0 if the two streams match, 1 if not
+static int check_line(const position_t endpoint)
+{
+	uint32_t base_count = base_line(endpoint, base_instr);
+
+	g_mi_buffer_head = 0;
+	g_mi_buffer_tail = 0;
+	if(move_to_endpoint(endpoint) != MI_BUFFER_OK)
+	{
+		printf("(%d, %d): could not be queued\n", endpoint.x, endpoint.y);
+		return 1;
+	}
+
+	uint32_t seg_count = 0;
+	mouse_instr_t instr;
+	while(seg_count < LINE_MAX_STEPS && mi_buffer_pop(&instr) == MI_BUFFER_OK)
+		seg_instr[seg_count++] = instr;
+
+	if(seg_count != base_count)
+	{
+		printf("(%d, %d): %u steps, baseline %u\n",
+		       endpoint.x, endpoint.y, seg_count, base_count);
+		return 1;
+	}
+
+	for(uint32_t s = 0; s < seg_count; s++)
+	{
+		if(seg_instr[s] != base_instr[s])
+		{
+			printf("(%d, %d): step %u is 0x%02X, baseline 0x%02X\n",
+			       endpoint.x, endpoint.y, s, seg_instr[s], base_instr[s]);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	uint32_t lines = 0, fails = 0;
+
+	printf("Line Segment Check\n");
+
+	// Every endpoint near the origin, where the error terms are smallest
+	for(int16_t y = -LINE_DENSE; y <= LINE_DENSE; y++)
+	{
+		for(int16_t x = -LINE_DENSE; x <= LINE_DENSE; x++)
+		{
+			fails += check_line((position_t){x, y});
+			lines++;
+		}
+	}
+	printf("Dense    %5u lines within +/-%d\n", lines, LINE_DENSE);
+
+	// Long lines out to either corner of the box, and along both axes
+	uint32_t dense = lines;
+	for(int16_t y = -LINE_COARSE_Y; y <= LINE_COARSE_Y; y += LINE_COARSE_STEP_Y)
+	{
+		for(int16_t x = -LINE_COARSE_X; x <= LINE_COARSE_X; x += LINE_COARSE_STEP_X)
+		{
+			fails += check_line((position_t){x, y});
+			fails += check_line((position_t){x, 0});
+			fails += check_line((position_t){0, y});
+			lines += 3;
+		}
+	}
+	fails += check_line((position_t){ LINE_COARSE_X,  LINE_COARSE_Y});
+	fails += check_line((position_t){-LINE_COARSE_X, -LINE_COARSE_Y});
+	lines += 2;
+	printf("Coarse   %5u lines within +/-%d, +/-%d\n",
+	       lines - dense, LINE_COARSE_X, LINE_COARSE_Y);
+
+	printf("\n%u lines, %u mismatched\n", lines, fails);
+	printf("%s\n", fails ? "FAIL" : "PASS");
+	return fails ? 1 : 0;
+}
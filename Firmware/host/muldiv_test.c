@@ -0,0 +1,401 @@
+/******************************************************************************
+* Host test of the soft multiply and divide routines in ch32v003fun.c. The
+* Makefile cuts them out of the toolkit into build/fun_muldiv.c, which is
+* built here under new names, so they don't stand in for the host's own.
+*
+* Each routine is checked against the M extension's results, which libgcc
+* gives too, division by zero and INT_MIN / -1 included. Every pair of 12
+* bit operands, signed and unsigned, every 16 bit value against a set of
+* edge values both ways round, and random pairs with their bit lengths
+* spread evenly.
+*
+* Then counts the instructions each takes on the CH32V003, both the libgcc
+* routines and these, by walking the path each takes for the operands. The
+* instructions on each path are counted by hand from the rv32ec code of the
+* libgcc assembly and of what GCC makes of these at -Os.
+*
+* Build and run with:    make host-muldiv
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Build the firmware's versions under names the host doesn't use
+#define WEAK       __attribute__((weak))
+#define __mulsi3   fun_mulsi3
+#define __udivsi3  fun_udivsi3
+#define __umodsi3  fun_umodsi3
+#define __divsi3   fun_divsi3
+#define __modsi3   fun_modsi3
+#include "fun_muldiv.c"
+#undef __modsi3
+#undef __divsi3
+#undef __umodsi3
+#undef __udivsi3
+#undef __mulsi3
+
+
+/*** Test Settings ***********************************************************/
+#define MULDIV_TEST_SMALL    12         // Bits of the operands checked in every pair
+#define MULDIV_TEST_RANDOM   16000000   // Random pairs
+#define MULDIV_TEST_ESTIMATE 1000000    // Random pairs the average counts are over
+#define MULDIV_TEST_SEED     0x9E3779B9
+
+// libgcc's muldi3.S and div.S for rv32. Instructions on each path
+#define INS_GCC_MUL          3          // Moves and return
+#define INS_GCC_MUL_BIT      5          // Test, branch, two shifts, loop
+#define INS_GCC_DIV          6          // Moves, zero test, compare
+#define INS_GCC_DIV_ZERO     5          // Division by zero returns early
+#define INS_GCC_ALIGN        4          // Sign test, two shifts, loop
+#define INS_GCC_QBIT         5          // Compare, two shifts, loop
+#define INS_GCC_SUB          2          // Subtract, set the quotient bit
+#define INS_GCC_MOD          3          // Saves ra, calls divide, moves
+#define INS_GCC_SIGNED       6          // Sign tests, negates and call
+
+// The routines here
+#define INS_MUL              5          // Compare, clear, zero test, return
+#define INS_MUL_SWAP         3          // Operands swapped
+#define INS_MUL_PASS         11         // Four bit tests, two shifts, loop
+#define INS_MUL_ADD          2          // Shift and add, one for bit 0
+#define INS_DIV_EARLY        3          // Divisor bigger, or zero
+#define INS_DIV_POW2         5          // Power of two test, mask, shift
+#define INS_DIV_LOG_STEP     4          // Compare, shift, count, loop
+#define INS_DIV_ALIGN_STEP   5          // Shift, compare, shift, count, loop
+#define INS_DIV_ALIGN_END    4          // The two failed compares
+#define INS_DIV_DUFF         8          // Pass count, jump into the loop
+#define INS_DIV_QBIT         4          // Shift, compare, shift, loop share
+#define INS_DIV_SUB          2          // Subtract, set the quotient bit
+#define INS_DIV_END          2          // Remainder and return
+#define INS_SIGNED           8          // Zero test, two negates, sign fix
+
+
+static uint32_t muldiv_test_rng = MULDIV_TEST_SEED;
+
+/// @brief A failing pair, printed once per routine
+static uint32_t muldiv_test_fails[5];
+static const char *muldiv_test_names[5] = {
+	"__mulsi3", "__udivsi3", "__umodsi3", "__divsi3", "__modsi3"
+};
+
+
+
+/*** Reference ***************************************************************/
+/// @brief What the M extension, and libgcc, give for each operation
+static uint32_t ref_udiv(const uint32_t n, const uint32_t d) { return d ? n / d : 0xFFFFFFFF; }
+static uint32_t ref_umod(const uint32_t n, const uint32_t d) { return d ? n % d : n; }
+
+static int32_t ref_div(const int32_t a, const int32_t b)
+{
+	if(b == 0) return -1;
+	if(a == INT32_MIN && b == -1) return INT32_MIN;
+	return a / b;
+}
+
+static int32_t ref_mod(const int32_t a, const int32_t b)
+{
+	if(b == 0) return a;
+	if(a == INT32_MIN && b == -1) return 0;
+	return a % b;
+}
+
+
+/// @brief Xorshift32, so the values are the same on every host
+static uint32_t muldiv_test_rand(void)
+{
+	muldiv_test_rng ^= muldiv_test_rng << 13;
+	muldiv_test_rng ^= muldiv_test_rng >> 17;
+	muldiv_test_rng ^= muldiv_test_rng << 5;
+	return muldiv_test_rng;
+}
+
+
+/// @brief A random value, with the bit lengths spread evenly
+static uint32_t muldiv_test_value(void)
+{
+	uint32_t bits = muldiv_test_rand() & 31;
+	return muldiv_test_rand() >> bits;
+}
+
+
+
+/*** Checks ******************************************************************/
+/// @brief Notes a mismatch, and prints the first for each routine
+static void muldiv_test_fail(const uint8_t func, const uint32_t a, const uint32_t b,
+                             const uint32_t got, const uint32_t want)
+{
+	if(muldiv_test_fails[func]++ == 0)
+		printf("  %s(0x%08X, 0x%08X) = 0x%08X, not 0x%08X\n",
+		       muldiv_test_names[func], a, b, got, want);
+}
+
+
+/// @brief Checks all five routines on one pair of operands
+static void muldiv_test_pair(const uint32_t a, const uint32_t b)
+{
+	uint32_t got, want;
+
+	if((got = fun_mulsi3(a, b)) != (want = a * b))       muldiv_test_fail(0, a, b, got, want);
+	if((got = fun_udivsi3(a, b)) != (want = ref_udiv(a, b))) muldiv_test_fail(1, a, b, got, want);
+	if((got = fun_umodsi3(a, b)) != (want = ref_umod(a, b))) muldiv_test_fail(2, a, b, got, want);
+
+	got  = (uint32_t)fun_divsi3((int32_t)a, (int32_t)b);
+	want = (uint32_t)ref_div((int32_t)a, (int32_t)b);
+	if(got != want) muldiv_test_fail(3, a, b, got, want);
+
+	got  = (uint32_t)fun_modsi3((int32_t)a, (int32_t)b);
+	want = (uint32_t)ref_mod((int32_t)a, (int32_t)b);
+	if(got != want) muldiv_test_fail(4, a, b, got, want);
+}
+
+
+/// @brief Edge values. Zero, the ends of each sign, every power of two and
+/// the values either side, and the divisors the firmware uses
+static uint32_t muldiv_test_edges(uint32_t *edge)
+{
+	uint32_t count = 0;
+	const uint32_t fixed[] = {
+		0, 1, 3, 10, 48, 1000, 15625, 16777619u, 0x7FFFFFFF, 0x80000000,
+		0xFFFFFFFF, 0xFFFFFFFE, 0x80000001, 0x55555555, 0xAAAAAAAA
+	};
+
+	for(size_t f = 0; f < sizeof(fixed) / sizeof(fixed[0]); f++) edge[count++] = fixed[f];
+	for(uint32_t b = 1; b < 32; b++)
+	{
+		edge[count++] = 1u << b;
+		edge[count++] = (1u << b) - 1;
+		edge[count++] = (1u << b) + 1;
+		edge[count++] = 0u - (1u << b);
+	}
+	return count;
+}
+
+
+/// @brief Runs every check
+/// @return Pairs checked
+static uint64_t muldiv_test_all(void)
+{
+	uint64_t pairs = 0;
+
+	// Every pair of small operands, as they are and sign extended
+	const uint32_t small = 1u << MULDIV_TEST_SMALL;
+	const uint32_t sign  = small >> 1;
+	for(uint32_t a = 0; a < small; a++)
+	{
+		for(uint32_t b = 0; b < small; b++)
+		{
+			muldiv_test_pair(a, b);
+			muldiv_test_pair((a ^ sign) - sign, (b ^ sign) - sign);
+		}
+	}
+	pairs += 2ull * small * small;
+
+	// Every 16 bit value against each edge, both ways round, and shifted up
+	// to the top half
+	uint32_t edge[160];
+	uint32_t edges = muldiv_test_edges(edge);
+	for(uint32_t e = 0; e < edges; e++)
+	{
+		for(uint32_t v = 0; v < 0x10000; v++)
+		{
+			muldiv_test_pair(edge[e], v);
+			muldiv_test_pair(v, edge[e]);
+			muldiv_test_pair(edge[e], v << 16);
+			muldiv_test_pair(v << 16, edge[e]);
+		}
+	}
+	pairs += 4ull * edges * 0x10000;
+
+	for(uint32_t r = 0; r < MULDIV_TEST_RANDOM; r++)
+		muldiv_test_pair(muldiv_test_value(), muldiv_test_value());
+	pairs += MULDIV_TEST_RANDOM;
+
+	return pairs;
+}
+
+
+
+/*** Instruction Counts ******************************************************/
+/// @brief libgcc's __mulsi3, one pass per bit of the second operand
+static uint32_t ins_gcc_mul(uint32_t a, uint32_t b)
+{
+	uint32_t ins = INS_GCC_MUL;
+	(void)a;
+	do {
+		ins += INS_GCC_MUL_BIT + (b & 1);
+		b >>= 1;
+	} while(b);
+	return ins;
+}
+
+
+/// @brief libgcc's __udivsi3. Doubles the divisor until it passes the
+/// dividend, then one pass per bit back down
+static uint32_t ins_gcc_udiv(uint32_t n, uint32_t d)
+{
+	if(d == 0) return INS_GCC_DIV_ZERO;
+
+	uint32_t ins = INS_GCC_DIV, bit = 1;
+	if(d < n)
+	{
+		while((int32_t)d > 0)
+		{
+			ins += INS_GCC_ALIGN;
+			d <<= 1;
+			bit <<= 1;
+			if(n <= d) break;
+		}
+	}
+
+	do {
+		ins += INS_GCC_QBIT;
+		if(n >= d) { n -= d; ins += INS_GCC_SUB; }
+		d >>= 1;
+		bit >>= 1;
+	} while(bit);
+	return ins + 2;
+}
+
+
+/// @brief __mulsi3 here
+static uint32_t ins_fun_mul(uint32_t a, uint32_t b)
+{
+	uint32_t ins = INS_MUL;
+	if(a < b) { ins += INS_MUL_SWAP; b = a; }
+
+	for(; b; b >>= 4)
+	{
+		ins += INS_MUL_PASS + (b & 1);
+		for(uint32_t bit = 2; bit < 16; bit <<= 1)
+			if(b & bit) ins += INS_MUL_ADD;
+	}
+	return ins;
+}
+
+
+/// @brief fun_udivmod() here, from the path the operands take
+static uint32_t ins_fun_udiv(uint32_t n, uint32_t d)
+{
+	if(d > n || d == 0) return INS_DIV_EARLY + (d == 0);
+
+	if(!(d & (d - 1)))
+	{
+		uint32_t ins = INS_DIV_EARLY + INS_DIV_POW2;
+		while(d > 15) { d >>= 4; ins += INS_DIV_LOG_STEP; }
+		while(d > 1)  { d >>= 1; ins += INS_DIV_LOG_STEP; }
+		return ins;
+	}
+
+	uint32_t ins = INS_DIV_EARLY + INS_DIV_POW2 + INS_DIV_ALIGN_END + INS_DIV_DUFF + INS_DIV_END;
+	uint32_t s = 0;
+	while((n >> 4) >= d) { d <<= 4; s += 4; ins += INS_DIV_ALIGN_STEP; }
+	while((n >> 1) >= d) { d <<= 1; s++;    ins += INS_DIV_ALIGN_STEP; }
+
+	for(uint32_t b = 0; b <= s; b++)
+	{
+		ins += INS_DIV_QBIT;
+		if(n >= d) { n -= d; ins += INS_DIV_SUB; }
+		d >>= 1;
+	}
+	return ins;
+}
+
+
+/// @brief Operations the firmware and the printf do, and random ones
+typedef struct {
+	const char       *name;
+	uint8_t          op;                // 0 multiply, 1 divide, 2 signed divide
+	uint32_t         a, b;
+} muldiv_case_t;
+
+static const muldiv_case_t muldiv_cases[] = {
+	{"FNV-1a hash * prime",         0, 0x811C9DC5,  16777619u},
+	{"distance * Q15 magnitude",    0, 240,         23170},
+	{"tile * Halton Q16",           0, 0x9E37,      96},
+	{"speed * period_us",           0, 1200,        1000},
+	{"small * small",               0, 7,           12},
+	{"poll period / 48",            1, 48000,       48},
+	{"units / 15625",               1, 1200000,     15625},
+	{"brake trim / levels",         1, 0x00034000,  12},
+	{"x / 16",                      1, 123456,      16},
+	{"x / 10",                      1, 4000000000u, 10},
+	{"small / bigger",              1, 12,          1000},
+	{"-1200 / 7",                   2, (uint32_t)-1200, 7},
+};
+#define MULDIV_CASES         (sizeof(muldiv_cases) / sizeof(muldiv_cases[0]))
+
+
+/// @brief Instructions for a case, libgcc then here
+static void muldiv_count(const uint8_t op, const uint32_t a, const uint32_t b,
+                         uint32_t *gcc, uint32_t *fun)
+{
+	if(op == 0)
+	{
+		*gcc = ins_gcc_mul(a, b);
+		*fun = ins_fun_mul(a, b);
+		return;
+	}
+
+	uint32_t n = a, d = b, sign = 0;
+	if(op == 2)
+	{
+		n = ((int32_t)a < 0) ? 0 - a : a;
+		d = ((int32_t)b < 0) ? 0 - b : b;
+		sign = 1;
+	}
+	*gcc = ins_gcc_udiv(n, d) + sign * INS_GCC_SIGNED;
+	*fun = ins_fun_udiv(n, d) + sign * INS_SIGNED;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	int fails = 0;
+
+	printf("Soft multiply and divide against the M extension's results\n\n");
+
+	uint64_t pairs = muldiv_test_all();
+	for(uint8_t f = 0; f < 5; f++)
+	{
+		if(muldiv_test_fails[f]) fails++;
+		printf("%-10s %llu pairs, %u mismatch(es): %s\n", muldiv_test_names[f],
+		       (unsigned long long)pairs, muldiv_test_fails[f],
+		       muldiv_test_fails[f] ? "FAIL" : "PASS");
+	}
+
+	// Instruction counts, the firmware's operations then random operands
+	printf("\nInstructions on the CH32V003, libgcc -> these\n\n");
+	for(size_t c = 0; c < MULDIV_CASES; c++)
+	{
+		uint32_t gcc, fun;
+		muldiv_count(muldiv_cases[c].op, muldiv_cases[c].a, muldiv_cases[c].b, &gcc, &fun);
+		printf("  %-28s %5u -> %4u %5.1fx\n", muldiv_cases[c].name, gcc, fun, (double)gcc / fun);
+	}
+
+	const char *op_names[3] = {"multiply", "unsigned divide", "signed divide"};
+	printf("\nAverage over %d random pairs, bit lengths spread evenly\n\n", MULDIV_TEST_ESTIMATE);
+	for(uint8_t op = 0; op < 3; op++)
+	{
+		uint64_t gcc_sum = 0, fun_sum = 0;
+		for(uint32_t r = 0; r < MULDIV_TEST_ESTIMATE; r++)
+		{
+			uint32_t a = muldiv_test_value(), b = muldiv_test_value();
+			uint32_t gcc, fun;
+
+			// Keep the divides from mostly taking the early return
+			if(op != 0 && b > a) { uint32_t t = a; a = b; b = t; }
+			muldiv_count(op, a, b, &gcc, &fun);
+			gcc_sum += gcc;
+			fun_sum += fun;
+		}
+		printf("  %-28s %5.1f -> %5.1f %5.1fx\n", op_names[op],
+		       (double)gcc_sum / MULDIV_TEST_ESTIMATE, (double)fun_sum / MULDIV_TEST_ESTIMATE,
+		       (double)gcc_sum / fun_sum);
+	}
+
+	printf("\n%d check(s) failed\n\n", fails);
+	return fails ? 1 : 0;
+}
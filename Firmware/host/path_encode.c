@@ -0,0 +1,285 @@
+/******************************************************************************
+* Recorded Path Encoder - Turns step or delta logs into compressed recordings
+* for Playback mode, in the layout decoded by patterns.h.
+* A log is one "dx dy" movement per line, # starts a comment. Movements
+* longer than one unit are split into unit steps along a straight line.
+* The steps become a chain code of turns, which is canonical Huffman coded,
+* and the start point is set so the drawing is centred.
+*
+* Run by make on the logs in recordings/, writing $(BUILD_DIR)/recordings.h
+* Usage:  path_encode <log> [log ...] > recordings.h
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "patterns.h"
+
+
+/*** Encoder *****************************************************************/
+/// @brief Encoded recording, and the figures the benchmark reports
+typedef struct {
+	uint8_t          *data;
+	size_t           size;              // Bytes, including the header
+	size_t           steps;
+} path_recording_t;
+
+
+/// @brief Unit step list being built from a log
+typedef struct {
+	uint8_t          *dir;              // Chain code direction of each step
+	size_t           count;
+	size_t           capacity;
+} path_steps_t;
+
+
+/// @brief Chain code direction of a unit step, anticlockwise from +X
+static uint8_t path_direction(const int dx, const int dy)
+{
+	for(uint8_t d = 0; d < 8; d++)
+		if(_pattern_dir_x[d] == dx && _pattern_dir_y[d] == dy) return d;
+	return 0;
+}
+
+
+/// @brief Appends a movement as unit steps along a straight line
+void path_add_delta(path_steps_t *steps, int dx, int dy)
+{
+	int n = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+	int x = 0, y = 0;
+
+	for(int i = 1; i <= n; i++)
+	{
+		// Round each point of the line to the nearest unit
+		int nx = (2 * dx * i + (dx >= 0 ? n : -n)) / (2 * n);
+		int ny = (2 * dy * i + (dy >= 0 ? n : -n)) / (2 * n);
+
+		if(steps->count == steps->capacity)
+		{
+			steps->capacity = steps->capacity ? steps->capacity * 2 : 1024;
+			steps->dir = realloc(steps->dir, steps->capacity);
+		}
+		steps->dir[steps->count++] = path_direction(nx - x, ny - y);
+		x = nx;
+		y = ny;
+	}
+}
+
+
+/// @brief Huffman code lengths from symbol counts, limited to
+/// PLAYBACK_MAX_BITS. Unused symbols get length 0
+static void path_code_lengths(const size_t *freq, uint8_t *len)
+{
+	// Build the tree by merging the two lightest nodes, tracking parents
+	size_t weight[2 * PLAYBACK_SYMBOLS];
+	int    parent[2 * PLAYBACK_SYMBOLS];
+	int    live[2 * PLAYBACK_SYMBOLS];
+	int    nodes = 0, n_live = 0;
+
+	for(int s = 0; s < PLAYBACK_SYMBOLS; s++)
+	{
+		len[s] = 0;
+		weight[s] = freq[s];
+		parent[s] = -1;
+		if(freq[s]) live[n_live++] = s;
+	}
+	nodes = PLAYBACK_SYMBOLS;
+
+	// A single symbol still needs a 1 bit code
+	if(n_live == 1) { len[live[0]] = 1; return; }
+
+	while(n_live > 1)
+	{
+		// Find the two lightest live nodes
+		int a = 0, b = 1;
+		if(weight[live[b]] < weight[live[a]]) { a = 1; b = 0; }
+		for(int i = 2; i < n_live; i++)
+		{
+			if(weight[live[i]] < weight[live[a]])      { b = a; a = i; }
+			else if(weight[live[i]] < weight[live[b]]) { b = i; }
+		}
+
+		weight[nodes] = weight[live[a]] + weight[live[b]];
+		parent[nodes] = -1;
+		parent[live[a]] = nodes;
+		parent[live[b]] = nodes;
+
+		// Replace the pair with the new node
+		int hi = (a > b) ? a : b, lo = (a > b) ? b : a;
+		live[lo] = nodes++;
+		live[hi] = live[--n_live];
+	}
+
+	for(int s = 0; s < PLAYBACK_SYMBOLS; s++)
+	{
+		if(!freq[s]) continue;
+		for(int p = parent[s]; p >= 0; p = parent[p]) len[s]++;
+	}
+}
+
+
+/// @brief Encodes a step list into a recording
+path_recording_t path_encode(const path_steps_t *steps)
+{
+	path_recording_t rec = {0};
+	size_t  freq[PLAYBACK_SYMBOLS] = {0};
+	uint8_t len[PLAYBACK_SYMBOLS];
+
+	// Turns between steps, the first is relative to its own direction
+	uint8_t last = steps->count ? steps->dir[0] : 0;
+	for(size_t i = 0; i < steps->count; i++)
+	{
+		freq[(steps->dir[i] - last) & 0x07]++;
+		last = steps->dir[i];
+	}
+	freq[PLAYBACK_END]++;
+	path_code_lengths(freq, len);
+
+	// Canonical codes, shortest first then in symbol order
+	uint8_t  counts[PLAYBACK_MAX_BITS + 1] = {0};
+	uint16_t next[PLAYBACK_MAX_BITS + 2]   = {0};
+	uint16_t code[PLAYBACK_SYMBOLS];
+	for(int s = 0; s < PLAYBACK_SYMBOLS; s++) counts[len[s]]++;
+	counts[0] = 0;
+	for(int l = 1; l <= PLAYBACK_MAX_BITS; l++)
+		next[l + 1] = (next[l] + counts[l]) << 1;
+	for(int s = 0; s < PLAYBACK_SYMBOLS; s++)
+		if(len[s]) code[s] = next[len[s]]++;
+
+	// Bounding box of the path, so the start point centres it
+	int x = 0, y = 0, min_x = 0, max_x = 0, min_y = 0, max_y = 0;
+	for(size_t i = 0; i < steps->count; i++)
+	{
+		x += _pattern_dir_x[steps->dir[i]];
+		y += _pattern_dir_y[steps->dir[i]];
+		if(x < min_x) min_x = x;
+		if(x > max_x) max_x = x;
+		if(y < min_y) min_y = y;
+		if(y > max_y) max_y = y;
+	}
+	int16_t start_x = (int16_t)(-(min_x + max_x) / 2);
+	int16_t start_y = (int16_t)(-(min_y + max_y) / 2);
+
+	// Header
+	size_t bits = 0;
+	for(size_t i = 0; i < steps->count; i++)
+		bits += len[(steps->dir[i] - (i ? steps->dir[i - 1] : steps->dir[0])) & 0x07];
+	bits += len[PLAYBACK_END];
+
+	rec.size  = PLAYBACK_CODES + (bits + 7) / 8;
+	rec.steps = steps->count;
+	rec.data  = calloc(rec.size, 1);
+
+	for(int l = 1; l <= PLAYBACK_MAX_BITS; l++) rec.data[PLAYBACK_COUNTS + l - 1] = counts[l];
+	int order = 0;
+	for(int l = 1; l <= PLAYBACK_MAX_BITS; l++)
+		for(int s = 0; s < PLAYBACK_SYMBOLS; s++)
+			if(len[s] == l) rec.data[PLAYBACK_ORDER + order++] = s;
+
+	rec.data[PLAYBACK_START + 0] = (uint8_t)start_x;
+	rec.data[PLAYBACK_START + 1] = (uint8_t)((uint16_t)start_x >> 8);
+	rec.data[PLAYBACK_START + 2] = (uint8_t)start_y;
+	rec.data[PLAYBACK_START + 3] = (uint8_t)((uint16_t)start_y >> 8);
+	rec.data[PLAYBACK_DIR]       = steps->count ? steps->dir[0] : 0;
+
+	// Codes, MSB first
+	size_t pos = 0;
+	for(size_t i = 0; i <= steps->count; i++)
+	{
+		uint8_t sym = (i == steps->count) ? PLAYBACK_END
+		            : (steps->dir[i] - (i ? steps->dir[i - 1] : steps->dir[0])) & 0x07;
+
+		for(int b = len[sym] - 1; b >= 0; b--, pos++)
+			if((code[sym] >> b) & 0x01)
+				rec.data[PLAYBACK_CODES + (pos >> 3)] |= 0x80 >> (pos & 0x07);
+	}
+
+	return rec;
+}
+
+
+
+/*** Command Line ************************************************************/
+#ifndef PATH_ENCODE_LIBRARY
+/// @brief Reads a log into unit steps, returns 0 on failure
+static int path_read_log(const char *filename, path_steps_t *steps)
+{
+	FILE *fp = fopen(filename, "r");
+	if(!fp) return 0;
+
+	char line[256];
+	while(fgets(line, sizeof(line), fp))
+	{
+		int dx, dy;
+		char *hash = strchr(line, '#');
+		if(hash) *hash = '\0';
+		if(sscanf(line, "%d %d", &dx, &dy) == 2) path_add_delta(steps, dx, dy);
+	}
+
+	fclose(fp);
+	return 1;
+}
+
+
+/// @brief Turns the log filename into a C identifier
+static void path_name(const char *filename, char *name, const size_t max)
+{
+	const char *base = strrchr(filename, '/');
+	base = base ? base + 1 : filename;
+
+	size_t n = 0;
+	for(; base[n] && base[n] != '.' && n < max - 1; n++)
+	{
+		char c = base[n];
+		name[n] = ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) ? c : '_';
+	}
+	name[n] = '\0';
+}
+
+
+int main(int argc, char *argv[])
+{
+	char name[64];
+
+	printf("// Recorded paths for Playback mode, see patterns.h for the layout\n");
+	printf("// Generated by host/path_encode.c - Do not edit\n");
+	printf("#ifndef INSOMNIAC_RECORDINGS_H\n");
+	printf("#define INSOMNIAC_RECORDINGS_H\n\n");
+
+	for(int f = 1; f < argc; f++)
+	{
+		path_steps_t steps = {0};
+		if(!path_read_log(argv[f], &steps))
+		{
+			fprintf(stderr, "path_encode: cannot read %s\n", argv[f]);
+			return 1;
+		}
+
+		path_recording_t rec = path_encode(&steps);
+		path_name(argv[f], name, sizeof(name));
+
+		printf("// %s: %zu steps in %zu Bytes\n", argv[f], rec.steps, rec.size);
+		printf("static const uint8_t recording_%s[%zu] = {", name, rec.size);
+		for(size_t i = 0; i < rec.size; i++)
+			printf("%s0x%02X%s", (i % 12) ? " " : "\n\t", rec.data[i], (i + 1 < rec.size) ? "," : "");
+		printf("\n};\n\n");
+
+		free(rec.data);
+		free(steps.dir);
+	}
+
+	printf("#define RECORDING_COUNT    %d\n\n", argc - 1);
+	printf("static const uint8_t *const recordings[RECORDING_COUNT] = {\n");
+	for(int f = 1; f < argc; f++)
+	{
+		path_name(argv[f], name, sizeof(name));
+		printf("\trecording_%s,\n", name);
+	}
+	printf("};\n\n#endif\n");
+
+	return 0;
+}
+#endif
@@ -0,0 +1,287 @@
+/******************************************************************************
+* Host check for the integer pattern generators in patterns.h.
+* Runs every generator to completion, checks that each step is a single
+* 8-connected unit, and compares the step stream against a float reference -
+* the same curve sampled with libm and rasterized by chasing the rounded
+* points. Reports the worst distance of each stream from the true curve,
+* and the time per step of both. Built to stop on signed overflow, so the
+* largest radius patterns.h allows is checked to fit its int32_t terms.
+*
+* Build and run with:    make host-patterns
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "host_firmware.h"
+
+
+/*** Check Settings **********************************************************/
+#define CHECK_MAX_STEPS      200000     // Larger than any pattern below
+#define CHECK_REPEATS        50         // Timing runs per generator
+#define CHECK_SAMPLE_GAP     0.2        // Float curve sample spacing, units
+#define CHECK_SAMPLE_TAIL    64         // Samples past the end of the curve
+#define CHECK_MAX_DEVIATION  1.0        // Worst allowed distance from curve
+
+
+/// @brief Shapes to check, sized to the Virtual Cursor Box and to the largest
+/// radius patterns.h allows
+typedef enum {
+	SHAPE_CIRCLE,
+	SHAPE_ELLIPSE,
+	SHAPE_SPIRAL,
+	SHAPE_FIGURE_EIGHT,
+	SHAPE_LISSAJOUS
+} shape_t;
+
+static const struct {
+	shape_t          shape;
+	const char       *name;
+	int16_t          a;                 // X Radius, Amplitude or Pitch
+	int16_t          b;                 // Y Radius, Amplitude or Max Radius
+	uint8_t          fx;
+	uint8_t          fy;
+} check_shapes[] = {
+	{SHAPE_CIRCLE,        "Circle r=300",      300, 300, 0, 0},
+	{SHAPE_CIRCLE,        "Circle r=7",          7,   7, 0, 0},
+	{SHAPE_ELLIPSE,       "Ellipse 400x300",   400, 300, 0, 0},
+	{SHAPE_ELLIPSE,       "Ellipse 400x20",    400,  20, 0, 0},
+	{SHAPE_CIRCLE,        "Circle r=max",      PATTERN_MAX_RADIUS, PATTERN_MAX_RADIUS, 0, 0},
+	{SHAPE_ELLIPSE,       "Ellipse max x 20",  PATTERN_MAX_RADIUS,  20, 0, 0},
+	{SHAPE_SPIRAL,        "Spiral p=16 r=300",  16, 300, 0, 0},
+	{SHAPE_SPIRAL,        "Spiral p=31 r=150",  31, 150, 0, 0},
+	{SHAPE_FIGURE_EIGHT,  "Figure-Eight",      400, 300, 1, 2},
+	{SHAPE_LISSAJOUS,     "Lissajous 3:2",     400, 300, 3, 2},
+};
+
+
+/// @brief A point on a step stream or a float curve
+typedef struct {
+	double           x;
+	double           y;
+} point_t;
+
+
+static point_t  int_path[CHECK_MAX_STEPS + 1];
+static point_t  ref_path[CHECK_MAX_STEPS + 1];
+static point_t  curve[4 * CHECK_MAX_STEPS];
+
+
+
+/*** Helpers *****************************************************************/
+/// @brief Starts the integer generator for a shape
+static void start_pattern(const size_t s, pattern_t *pat)
+{
+	switch(check_shapes[s].shape)
+	{
+		case SHAPE_CIRCLE:
+		case SHAPE_ELLIPSE:
+			pattern_ellipse(pat, check_shapes[s].a, check_shapes[s].b);
+			break;
+
+		case SHAPE_SPIRAL:
+			pattern_spiral(pat, (uint8_t)check_shapes[s].a, check_shapes[s].b);
+			break;
+
+		case SHAPE_FIGURE_EIGHT:
+		case SHAPE_LISSAJOUS:
+			pattern_lissajous(pat, check_shapes[s].a, check_shapes[s].b,
+			                  check_shapes[s].fx, check_shapes[s].fy);
+			break;
+	}
+}
+
+
+/// @brief Point on the true curve at parameter t, and how far t can move
+/// for one sample gap, so samples are evenly spaced along the curve.
+/// Returns 0 once t is past the end of the curve
+static int curve_point(const size_t s, const double t, point_t *p, double *dt)
+{
+	const double a = check_shapes[s].a, b = check_shapes[s].b;
+	const double fx = check_shapes[s].fx, fy = check_shapes[s].fy;
+
+	switch(check_shapes[s].shape)
+	{
+		case SHAPE_CIRCLE:
+		case SHAPE_ELLIPSE:
+			p->x = a * cos(t);
+			p->y = b * sin(t);
+			*dt  = CHECK_SAMPLE_GAP / hypot(a * sin(t), b * cos(t));
+			return t <= 2.0 * M_PI;
+
+		// r = pitch * t / 2pi, from r = pitch to r = max
+		case SHAPE_SPIRAL: {
+			double r = a * t / (2.0 * M_PI);
+			p->x = r * cos(t);
+			p->y = r * sin(t);
+			*dt  = CHECK_SAMPLE_GAP / hypot(r, a / (2.0 * M_PI));
+			return r <= b;
+		}
+
+		case SHAPE_FIGURE_EIGHT:
+		case SHAPE_LISSAJOUS:
+			p->x = a * cos(fx * t);
+			p->y = b * sin(fy * t);
+			*dt  = CHECK_SAMPLE_GAP / hypot(a * fx * sin(fx * t), b * fy * cos(fy * t));
+			return t <= 2.0 * M_PI;
+	}
+
+	return 0;
+}
+
+
+/// @brief Starting parameter of each curve
+static double curve_start(const size_t s)
+{
+	if(check_shapes[s].shape == SHAPE_SPIRAL) return 2.0 * M_PI;
+	return 0.0;
+}
+
+
+/// @brief Samples the true curve densely, returns the number of samples.
+/// Carries on for CHECK_SAMPLE_TAIL samples past the end, a stream that
+/// stops a unit or two late is still measured against the curve
+static size_t sample_curve(const size_t s)
+{
+	size_t n = 0, tail = 0;
+	double t = curve_start(s), dt;
+	point_t p;
+
+	while(n < sizeof(curve) / sizeof(curve[0]) && tail < CHECK_SAMPLE_TAIL)
+	{
+		if(!curve_point(s, t, &p, &dt)) tail++;
+		curve[n++] = p;
+		t += dt;
+	}
+
+	return n;
+}
+
+
+/// @brief Runs the integer generator, storing every point it visits.
+/// Returns the number of steps, or 0 if a step was not a single unit
+static size_t run_integer(const size_t s, point_t *path)
+{
+	pattern_t pat = {0};
+	pattern_step_t step;
+	size_t n = 0;
+
+	start_pattern(s, &pat);
+	if(path) path[0] = (point_t){pat.x, pat.y};
+
+	while(n < CHECK_MAX_STEPS && pattern_step(&pat, &step))
+	{
+		if(abs(step.x) > 1 || abs(step.y) > 1 || (!step.x && !step.y)) return 0;
+		n++;
+		if(path) path[n] = (point_t){pat.x, pat.y};
+	}
+
+	return n;
+}
+
+
+/// @brief Float reference rasterizer. Samples the curve with libm and steps
+/// towards each rounded point. Returns the number of steps
+static size_t run_reference(const size_t s, point_t *path)
+{
+	double t = curve_start(s), dt;
+	point_t p;
+	size_t n = 0;
+
+	curve_point(s, t, &p, &dt);
+	long x = lround(p.x), y = lround(p.y);
+	if(path) path[0] = (point_t){x, y};
+
+	while(n < CHECK_MAX_STEPS && curve_point(s, t, &p, &dt))
+	{
+		long tx = lround(p.x), ty = lround(p.y);
+		while((tx != x || ty != y) && n < CHECK_MAX_STEPS)
+		{
+			x += (tx > x) - (tx < x);
+			y += (ty > y) - (ty < y);
+			n++;
+			if(path) path[n] = (point_t){x, y};
+		}
+		t += dt;
+	}
+
+	return n;
+}
+
+
+/// @brief Worst distance from a path to the sampled curve. Both travel the
+/// same way, so each point is only searched for near where the last was found
+static double worst_deviation(const point_t *path, const size_t steps,
+                              const size_t samples)
+{
+	const size_t back = 32, ahead = 32;
+	size_t j = 0;
+	double worst = 0.0;
+
+	for(size_t i = 0; i <= steps; i++)
+	{
+		size_t lo = (j > back) ? j - back : 0;
+		size_t hi = (j + ahead < samples) ? j + ahead : samples;
+		double best = INFINITY;
+
+		for(size_t k = lo; k < hi; k++)
+		{
+			double d = hypot(path[i].x - curve[k].x, path[i].y - curve[k].y);
+			if(d < best) { best = d; j = k; }
+		}
+		if(best > worst) worst = best;
+	}
+
+	return worst;
+}
+
+
+/// @brief Wall time per step of a rasterizer, over CHECK_REPEATS runs
+static double time_per_step(const size_t s, size_t (*run)(const size_t, point_t *))
+{
+	size_t steps = 0;
+	double start = host_now_ns();
+	for(int r = 0; r < CHECK_REPEATS; r++) steps += run(s, NULL);
+	return (host_now_ns() - start) / (double)steps;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	int fails = 0;
+
+	printf("Pattern generator check: integer vs float reference\n\n");
+	printf("%-20s %9s %9s %9s %9s %10s %10s  %s\n",
+	       "Pattern", "steps", "ref", "dev", "ref dev", "ns/step", "ref ns", "result");
+
+	for(size_t s = 0; s < sizeof(check_shapes) / sizeof(check_shapes[0]); s++)
+	{
+		size_t samples   = sample_curve(s);
+		size_t int_steps = run_integer(s, int_path);
+		size_t ref_steps = run_reference(s, ref_path);
+
+		double int_dev = int_steps ? worst_deviation(int_path, int_steps, samples) : INFINITY;
+		double ref_dev = worst_deviation(ref_path, ref_steps, samples);
+
+		// Closed curves must finish where they started
+		int closed = 1;
+		if(check_shapes[s].shape == SHAPE_CIRCLE || check_shapes[s].shape == SHAPE_ELLIPSE)
+			closed = (int_path[int_steps].x == int_path[0].x
+			       && int_path[int_steps].y == int_path[0].y);
+
+		int fail = (int_steps == 0 || int_dev > CHECK_MAX_DEVIATION || !closed);
+		fails += fail;
+
+		printf("%-20s %9zu %9zu %9.3f %9.3f %10.2f %10.2f  %s%s\n",
+		       check_shapes[s].name, int_steps, ref_steps, int_dev, ref_dev,
+		       time_per_step(s, run_integer), time_per_step(s, run_reference),
+		       fail ? "FAIL" : "PASS", closed ? "" : " (not closed)");
+	}
+
+	printf("\n%d pattern(s) failed\n\n", fails);
+	return fails ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+/******************************************************************************
+* Host benchmark for recorded path playback. Decodes every built-in
+* recording, then records the step stream of other modes, encodes it with
+* path_encode.c and plays it back through patterns.h, checking that every
+* step matches. Reports the compression ratio against a raw delta log, the
+* bits (decoder loop passes) per step, and the decode time per step.
+*
+* Build and run with:    make host-playback
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_firmware.h"
+
+#define PATH_ENCODE_LIBRARY
+#include "path_encode.c"
+
+
+/*** Benchmark Settings ******************************************************/
+#define PLAYBACK_POLLS       60000      // Polls recorded from each mode
+#define PLAYBACK_REPEATS     20         // Decode timing passes
+#define PLAYBACK_SEED        0x747AA32F
+#define PLAYBACK_RAW_BYTES   2          // Raw log is one int8_t dx, dy per step
+
+
+/// @brief Modes to record, in jumper order
+static const user_mode_t playback_modes[] = {
+	USER_MODE_NORMAL, USER_MODE_HI_RES, USER_MODE_JITTER, USER_MODE_PATTERN,
+};
+
+
+
+/*** Helpers *****************************************************************/
+/// @brief Records the steps a mode sends to the host, one per Report
+static path_steps_t record_mode(const user_mode_t mode)
+{
+	path_steps_t steps = {0};
+
+	host_firmware_reset(mode, PLAYBACK_SEED);
+
+	for(uint32_t p = 0; p < PLAYBACK_POLLS; p++)
+	{
+		motion_task();
+
+		host_packet_len = 0;
+		usb_handle_user_in_request(NULL, NULL, 1, 0, NULL);
+
+		int8_t dx = (host_packet_len >= 3) ? (int8_t)host_packet[1] : 0;
+		int8_t dy = (host_packet_len >= 3) ? (int8_t)host_packet[2] : 0;
+		if(dx || dy) path_add_delta(&steps, dx, dy);
+
+		DelaySysTick(Ticks_from_Ms(10));
+	}
+
+	return steps;
+}
+
+
+/// @brief Plays a recording back, optionally checking it against the steps
+/// it was made from. Returns the number of steps, or 0 on a mismatch
+static size_t play(const uint8_t *recording, const path_steps_t *expect)
+{
+	pattern_t pat;
+	pattern_step_t step;
+	size_t n = 0;
+
+	pattern_playback(&pat, recording);
+	while(pattern_step(&pat, &step))
+	{
+		if(expect)
+		{
+			if(n >= expect->count) return 0;
+			if(step.x != _pattern_dir_x[expect->dir[n]]
+			|| step.y != _pattern_dir_y[expect->dir[n]]) return 0;
+		}
+		n++;
+	}
+
+	if(expect && n != expect->count) return 0;
+	return n;
+}
+
+
+/// @brief Prints one row of results
+static void report(const char *name, const uint8_t *recording, const size_t size,
+                   const path_steps_t *expect)
+{
+	size_t steps = play(recording, expect);
+
+	double start = host_now_ns();
+	for(int r = 0; r < PLAYBACK_REPEATS; r++) play(recording, NULL);
+	double ns = (host_now_ns() - start) / ((double)PLAYBACK_REPEATS * (steps ? steps : 1));
+
+	printf("%-22s %9zu %9zu %10.1f:1 %10.2f %10.2f  %s\n", name, steps, size,
+	       steps ? (double)steps * PLAYBACK_RAW_BYTES / size : 0.0,
+	       steps ? 8.0 * (size - PLAYBACK_CODES) / steps : 0.0, ns,
+	       (steps || !expect) ? "PASS" : "FAIL");
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	int fails = 0;
+
+	printf("Playback benchmark: ratio against a %d Byte per step delta log\n\n",
+	       PLAYBACK_RAW_BYTES);
+	printf("%-22s %9s %9s %12s %10s %10s  %s\n",
+	       "Recording", "steps", "bytes", "ratio", "bits/step", "ns/step", "result");
+
+	// Built-in recordings from RECORD_DIR
+	for(int r = 0; r < RECORDING_COUNT; r++)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "Built-in %d", r);
+
+		// The size isn't stored, find the end of the codes by decoding
+		pattern_t pat;
+		pattern_step_t step;
+		pattern_playback(&pat, recordings[r]);
+		while(pattern_step(&pat, &step));
+
+		report(name, recordings[r], PLAYBACK_CODES + (pat.rec.bit + 7) / 8, NULL);
+	}
+
+	// Round trip the output of each mode
+	for(size_t m = 0; m < sizeof(playback_modes) / sizeof(playback_modes[0]); m++)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%s, recorded", host_mode_names[playback_modes[m]]);
+
+		path_steps_t steps   = record_mode(playback_modes[m]);
+		path_recording_t rec = path_encode(&steps);
+
+		if(!play(rec.data, &steps)) fails++;
+		report(name, rec.data, rec.size, &steps);
+
+		free(rec.data);
+		free(steps.dir);
+	}
+
+	printf("\n%d recording(s) failed to round trip\n\n", fails);
+	return fails ? 1 : 0;
+}
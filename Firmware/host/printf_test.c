@@ -0,0 +1,362 @@
+/******************************************************************************
+* Host test of the divide-free integer formatting in the toolkit's mini
+* printf. The Makefile cuts mini_itoa() to mini_pprintf() out of
+* ch32v003fun.c into build/mini_printf.c, which is built here.
+*
+* Three checks. mini_itoa() against the old divide loop, kept below with
+* the 32 bit long of the target, for every value it got right. Every value
+* the old loop got wrong, %u and %x with the top bit set and INT_MIN,
+* against glibc. Then mini_snprintf() against glibc snprintf() over random
+* values and the formats the mini printf supports, with the padding cases
+* where it has always differed from glibc checked against the old loop.
+*
+* Then estimates the cycles a number takes on the CH32V003 both ways, from
+* the libgcc divide loop and the subtract loop, and times both on the host.
+*
+* Build and run with:    make host-printf
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+// The toolkit declares this before the printf code
+int mini_vpprintf(int (*puts)(char* s, int len, void* buf), void* buf, const char *fmt, va_list va);
+#include "mini_printf.c"
+
+
+/*** Test Settings ***********************************************************/
+#define PRINTF_TEST_RANDOM   4000000    // Random values per check
+#define PRINTF_TEST_EDGE     100000     // Values either side of each edge
+#define PRINTF_TEST_TIMED    2000000    // Numbers per timing loop
+#define PRINTF_TEST_SEED     0x747AA32F
+
+// libgcc's __udivsi3 is a shift and subtract loop, one pass per quotient
+// bit. __divsi3 and __modsi3 add the sign handling. Cycles, one per
+// instruction and one more per taken branch
+#define CYC_DIV_CALL         18         // Call, signs, setup and return
+#define CYC_DIV_BIT          7          // One pass of the loop
+#define CYC_OLD_DIGIT        10         // Store, radix test, loop
+#define CYC_OLD_REVERSE      9          // Per pair of characters swapped
+#define CYC_NEW_SKIP         4          // Leading power of ten skipped
+#define CYC_NEW_SUB          4          // Compare, subtract, add, branch
+#define CYC_NEW_DIGIT        8          // Store, next power, end test
+#define CYC_HEX_DIGIT        9          // Shift, mask, pick, store, loop
+
+
+/// @brief Sizes the old and new versions are timed and estimated at
+static const uint32_t printf_test_values[] = {
+	0, 7, 42, 999, 65535, 1234567, 2147483647u, 4294967295u
+};
+#define PRINTF_TEST_VALUES   (sizeof(printf_test_values) / sizeof(printf_test_values[0]))
+
+
+static uint32_t printf_test_rng = PRINTF_TEST_SEED;
+
+
+
+/*** Reference ***************************************************************/
+/// @brief The old mini_itoa(), with long as the 32 bits it is on the target
+static int old_mini_itoa(int32_t value, unsigned int radix, int uppercase, int unsig,
+                         char *buffer)
+{
+	char    *pbuffer = buffer;
+	int     negative = 0;
+	int     i, len;
+
+	if (radix > 16)
+		return 0;
+
+	if (value < 0 && !unsig) {
+		negative = 1;
+		value = -value;
+	}
+
+	do {
+		int digit = value % (int32_t)radix;
+		*(pbuffer++) = (digit < 10 ? '0' + digit : (uppercase ? 'A' : 'a') + digit - 10);
+		value /= (int32_t)radix;
+	} while (value > 0);
+
+	if (negative)
+		*(pbuffer++) = '-';
+
+	*(pbuffer) = '\0';
+
+	len = (pbuffer - buffer);
+	for (i = 0; i < len / 2; i++) {
+		char j = buffer[i];
+		buffer[i] = buffer[len-i-1];
+		buffer[len-i-1] = j;
+	}
+
+	return len;
+}
+
+
+/// @brief Xorshift32, so the values are the same on every host
+static uint32_t printf_test_rand(void)
+{
+	printf_test_rng ^= printf_test_rng << 13;
+	printf_test_rng ^= printf_test_rng >> 17;
+	printf_test_rng ^= printf_test_rng << 5;
+	return printf_test_rng;
+}
+
+
+/// @brief A random value, with the digit counts spread evenly
+static uint32_t printf_test_value(void)
+{
+	uint32_t bits = printf_test_rand() & 31;
+	return printf_test_rand() >> bits;
+}
+
+
+/// @brief The value the old loop got right, when the target's long held it
+static int old_is_right(const uint32_t value, const int unsig)
+{
+	return unsig ? (value < 0x80000000u) : (value != 0x80000000u);
+}
+
+
+
+/*** Checks ******************************************************************/
+/// @brief Compares one value in every radix and sign the printf uses
+/// @return Mismatches
+static uint32_t printf_test_itoa(const uint32_t value)
+{
+	static const struct { unsigned int radix; int upper; int unsig; } kinds[] = {
+		{10, 0, 0}, {10, 0, 1}, {16, 0, 1}, {16, 1, 1},
+	};
+
+	uint32_t fails = 0;
+	char now[24], ref[24];
+
+	for(size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++)
+	{
+		int len = mini_itoa((long)(int32_t)value, kinds[k].radix, kinds[k].upper,
+		                    kinds[k].unsig, now);
+
+		int ref_len;
+		if(old_is_right(value, kinds[k].unsig))
+		{
+			ref_len = old_mini_itoa((int32_t)value, kinds[k].radix, kinds[k].upper,
+			                        kinds[k].unsig, ref);
+		}
+		else
+		{
+			const char *fmt = (kinds[k].radix == 10) ? (kinds[k].unsig ? "%u" : "%d")
+			                                         : (kinds[k].upper ? "%X" : "%x");
+			ref_len = snprintf(ref, sizeof(ref), fmt, value);
+		}
+
+		if(len != ref_len || strcmp(now, ref)) fails++;
+	}
+
+	return fails;
+}
+
+
+/// @brief Formats through mini_snprintf() and glibc, and compares
+static uint32_t printf_test_format(const char *fmt, const uint32_t value)
+{
+	char now[64], ref[64];
+	int  len     = mini_snprintf(now, sizeof(now), fmt, value);
+	int  ref_len = snprintf(ref, sizeof(ref), fmt, value);
+	return (len != ref_len || strcmp(now, ref)) ? 1 : 0;
+}
+
+
+/// @brief A padded number where the mini printf has always differed from
+/// glibc, zero padding before the sign or a number too wide for its
+/// field, against the old loop and the same mini_pad()
+static uint32_t printf_test_padded(const char *fmt, const char conv, const uint32_t value,
+                                   const char pad_char, const int pad_to)
+{
+	char now[64], digits[24], ref[64];
+	int  unsig = (conv != 'd');
+	if(!old_is_right(value, unsig)) return 0;
+
+	int  len = old_mini_itoa((int32_t)value, (conv == 'x') ? 16 : 10, 0, unsig, digits);
+	len = mini_pad(digits, len, pad_char, pad_to, ref);
+	ref[len] = '\0';
+
+	int now_len = mini_snprintf(now, sizeof(now), fmt, value);
+	return (now_len != len || strcmp(now, ref)) ? 1 : 0;
+}
+
+
+/// @brief Monotonic clock in ns
+static double printf_test_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+
+/*** Cycle Estimate **********************************************************/
+/// @brief Bits in a value, the passes the libgcc divide loop makes
+static uint32_t est_bits(uint32_t value)
+{
+	uint32_t bits = 0;
+	for(; value; value >>= 1) bits++;
+	return bits;
+}
+
+
+/// @brief The old decimal loop, a divide and a modulo for every digit
+static uint32_t est_old_decimal(uint32_t value)
+{
+	uint32_t cyc = 0, digits = 0;
+	do {
+		uint32_t passes = est_bits(value) > 3 ? est_bits(value) - 3 : 1;
+		cyc   += 2 * (CYC_DIV_CALL + passes * CYC_DIV_BIT) + CYC_OLD_DIGIT;
+		value /= 10;
+		digits++;
+	} while(value);
+	return cyc + (digits / 2) * CYC_OLD_REVERSE;
+}
+
+
+/// @brief The subtract loop, from the digits it writes
+static uint32_t est_new_decimal(const uint32_t value)
+{
+	char digits[24];
+	int  len = mini_itoa((long)value, 10, 0, 1, digits);
+
+	// Values under 100000 start half way down the table
+	uint32_t skip = (value < 100000) ? 5 - len : 10 - len;
+	uint32_t cyc  = CYC_NEW_SKIP + skip * CYC_NEW_SKIP;
+	for(int d = 0; d < len; d++)
+		cyc += (digits[d] - '0' + 1) * CYC_NEW_SUB + CYC_NEW_DIGIT;
+	return cyc;
+}
+
+
+/// @brief The old hex loop divides by 16 in libgcc too, the new one shifts
+static uint32_t est_old_hex(uint32_t value)
+{
+	uint32_t cyc = 0, digits = 0;
+	do {
+		uint32_t passes = est_bits(value) > 4 ? est_bits(value) - 4 : 1;
+		cyc   += 2 * (CYC_DIV_CALL + passes * CYC_DIV_BIT) + CYC_OLD_DIGIT;
+		value >>= 4;
+		digits++;
+	} while(value);
+	return cyc + (digits / 2) * CYC_OLD_REVERSE;
+}
+
+
+static uint32_t est_new_hex(const uint32_t value)
+{
+	uint32_t digits = (est_bits(value) + 3) / 4;
+	if(digits == 0) digits = 1;
+	return digits * (CYC_HEX_DIGIT + 4);
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	int fails = 0;
+
+	printf("Divide-free mini printf test\n\n");
+
+	// mini_itoa() against the old loop, or glibc where the old loop was wrong
+	uint32_t itoa_fails = 0, checked = 0;
+	static const uint32_t edges[] = {
+		0, 9, 10, 99, 100, 999999999, 1000000000, 0x7FFFFFFF, 0x80000000,
+		0xFFFFFFFF, 0x0FFFFFFF, 0x10000000,
+	};
+	for(size_t e = 0; e < sizeof(edges) / sizeof(edges[0]); e++)
+		for(int32_t d = -PRINTF_TEST_EDGE; d <= PRINTF_TEST_EDGE; d++, checked++)
+			itoa_fails += printf_test_itoa(edges[e] + (uint32_t)d);
+	for(uint32_t n = 0; n < PRINTF_TEST_RANDOM; n++, checked++)
+		itoa_fails += printf_test_itoa(printf_test_value());
+	if(itoa_fails) fails++;
+
+	printf("mini_itoa(): %u values, decimal and hex, signed and unsigned, %u mismatch(es): %s\n",
+	       checked, itoa_fails, itoa_fails ? "FAIL" : "PASS");
+
+	// The formats glibc and the mini printf agree on
+	static const char *formats[] = {
+		"%d", "%u", "%x", "%X", "%ld", "%lu", "%lx", "[%d]", "v=%u;",
+		"%12d", "%12u", "%012u", "%10x", "%08X", "%011d",
+	};
+	uint32_t fmt_fails = 0, fmt_checked = 0;
+	for(size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+	{
+		for(uint32_t n = 0; n < PRINTF_TEST_RANDOM / 8; n++)
+		{
+			uint32_t value = printf_test_value();
+
+			// Zero padding a negative number puts the zeros before the sign
+			if(strchr(formats[f], '0') && strchr(formats[f], 'd') && (int32_t)value < 0)
+				continue;
+			// long is 32 bits on the target, so %ld is signed at bit 31
+			if(strchr(formats[f], 'l'))
+			{
+				char now[64], ref[64];
+				long arg = strchr(formats[f], 'd') ? (long)(int32_t)value : (long)value;
+				mini_snprintf(now, sizeof(now), formats[f], arg);
+				snprintf(ref, sizeof(ref), formats[f], arg);
+				fmt_fails += strcmp(now, ref) ? 1 : 0;
+			}
+			else fmt_fails += printf_test_format(formats[f], value);
+			fmt_checked++;
+		}
+	}
+
+	// Where they have always differed, the old loop decides
+	static const struct { const char *fmt; char conv; char pad; int to; } padded[] = {
+		{"%05d", 'd', '0', 5}, {"%08d", 'd', '0', 8}, {"%3d", 'd', ' ', 3},
+		{"%4u", 'u', ' ', 4}, {"%2x", 'x', ' ', 2},
+	};
+	for(size_t p = 0; p < sizeof(padded) / sizeof(padded[0]); p++)
+	{
+		for(uint32_t n = 0; n < PRINTF_TEST_RANDOM / 8; n++, fmt_checked++)
+			fmt_fails += printf_test_padded(padded[p].fmt, padded[p].conv, printf_test_value(),
+			                                padded[p].pad, padded[p].to);
+	}
+	if(fmt_fails) fails++;
+
+	printf("mini_snprintf(): %u numbers in %zu formats, %u mismatch(es): %s\n",
+	       fmt_checked, sizeof(formats) / sizeof(formats[0]) + sizeof(padded) / sizeof(padded[0]),
+	       fmt_fails, fmt_fails ? "FAIL" : "PASS");
+
+	// Estimated target cycles and host time, per number
+	printf("\nEstimated cycles on the CH32V003 per number, old divide loop -> new\n\n");
+	printf("%12s %24s %24s %20s\n", "value", "%u", "%x", "host ns %u old/new");
+
+	volatile int sink = 0;
+	char buf[24];
+	for(size_t v = 0; v < PRINTF_TEST_VALUES; v++)
+	{
+		uint32_t value = printf_test_values[v];
+		uint32_t old_dec = est_old_decimal(value), new_dec = est_new_decimal(value);
+		uint32_t old_hex = est_old_hex(value),     new_hex = est_new_hex(value);
+
+		double start = printf_test_now_ns();
+		for(uint32_t n = 0; n < PRINTF_TEST_TIMED; n++)
+			sink += old_mini_itoa((int32_t)(value ^ (n & 1)), 10, 0, 1, buf);
+		double old_ns = (printf_test_now_ns() - start) / PRINTF_TEST_TIMED;
+
+		start = printf_test_now_ns();
+		for(uint32_t n = 0; n < PRINTF_TEST_TIMED; n++)
+			sink += mini_itoa((long)(value ^ (n & 1)), 10, 0, 1, buf);
+		double new_ns = (printf_test_now_ns() - start) / PRINTF_TEST_TIMED;
+
+		printf("%12u %7u -> %4u %6.1fx %7u -> %4u %6.1fx %9.1f / %5.1f\n", value,
+		       old_dec, new_dec, (double)old_dec / new_dec,
+		       old_hex, new_hex, (double)old_hex / new_hex, old_ns, new_ns);
+	}
+
+	printf("\n%d check(s) failed\n\n", fails);
+	return fails ? 1 : 0;
+}
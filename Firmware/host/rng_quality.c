@@ -0,0 +1,387 @@
+/******************************************************************************
+* Native quality and throughput suite for lib_rand and int_rand().
+* Replaces capturing int_rand() over debug printf and averaging the log.
+* Builds insomniac.c for Linux against the stand-ins in this folder, then runs
+* chi-square, runs, serial-correlation and period tests on the raw rand()
+* stream, and on int_rand() in every mode that plans random endpoints,
+* with the range from its row of the User Mode Registry, timing each test.
+* Then compares int_rand() with the mask-then-modulo it replaced, for cost
+* and bias. The host divides in hardware, rv32ec calls a software divide.
+*
+* Build and run for every RANDOM_STRENGTH with:    make host-rng
+* Usage:  rng_quality [samples] [log2 period search limit]
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "host_firmware.h"
+
+
+/*** Suite Settings **********************************************************/
+#define RNG_DEFAULT_SAMPLES       (1UL << 28)   // Samples per test
+#define RNG_DEFAULT_PERIOD_LOG2   33            // Give up the period search
+#define RNG_P_LOW                 0.0001        // p-values outside this band
+#define RNG_P_HIGH                0.9999        // are reported as a FAIL
+#define RNG_MAX_VALUES            1024          // Most values int_rand() may give
+
+
+
+/*** Helpers *****************************************************************/
+/// @brief Puts lib_rand back to its default seed, for repeatable runs
+static void rng_reset(void)
+{
+	_rand_lfsr   = 0x747AA32F;
+	_rand_lfsr_b = 0x159A55E5;
+}
+
+
+/// @brief Packs the whole generator state, both words for Strength 3
+static uint64_t rng_state(void)
+{
+	return ((uint64_t)_rand_lfsr_b << 32) | _rand_lfsr;
+}
+
+
+/// @brief Upper tail p-value of a chi-square statistic, using the
+/// Wilson-Hilferty normal approximation
+static double chi2_p(const double chi2, const double df)
+{
+	double z = (cbrt(chi2 / df) - (1.0 - 2.0 / (9.0 * df))) / sqrt(2.0 / (9.0 * df));
+	return 0.5 * erfc(z / M_SQRT2);
+}
+
+
+/// @brief Two sided p-value of a standard normal z-score
+static double z_p(const double z)
+{
+	return erfc(fabs(z) / M_SQRT2);
+}
+
+
+/// @brief Lag-1 serial correlation coefficient from running sums (Knuth)
+static double serial_corr(const double n, const double sum, const double sum_sq,
+                          const double sum_lag)
+{
+	double den = n * sum_sq - sum * sum;
+	return (den == 0.0) ? 0.0 : (n * sum_lag - sum * sum) / den;
+}
+
+
+/// @brief Prints one result row, returns 1 if it failed
+static int rng_report(const char *name, const char *stat, const double p,
+                      const double seconds)
+{
+	int fail = (p < RNG_P_LOW || p > RNG_P_HIGH);
+	printf("%-30s %-28s p=%-9.4f %-5s %8.3f s\n",
+	       name, stat, p, fail ? "FAIL" : "PASS", seconds);
+	return fail;
+}
+
+
+
+/*** Tests *******************************************************************/
+/// @brief Raw rand() throughput, with nothing else in the loop
+static void test_throughput(const uint64_t samples)
+{
+	rng_reset();
+	uint32_t sink = 0;
+
+	double start = host_now_ns();
+	for(uint64_t i = 0; i < samples; i++) sink ^= rand();
+	double took = (host_now_ns() - start) * 1e-9;
+
+	printf("%-30s %6.2f ns/call %31s %8.3f s   (sink %08X)\n",
+	       "rand() throughput", took * 1e9 / samples, "", took, sink);
+}
+
+
+/// @brief Chi-square of all four byte lanes, runs above/below the midpoint
+/// on the MSB, and lag-1 serial correlation of rand()
+static int test_rand_stream(const uint64_t samples)
+{
+	static uint64_t lanes[4][256];
+	int fails = 0;
+	char stat[64];
+
+	rng_reset();
+	for(int l = 0; l < 4; l++) for(int b = 0; b < 256; b++) lanes[l][b] = 0;
+
+	uint64_t runs = 1, ones = 0;
+	double sum = 0.0, sum_sq = 0.0, sum_lag = 0.0;
+
+	double start = host_now_ns();
+	uint32_t first = rand(), prev = first;
+	for(uint64_t i = 0; i < samples; i++)
+	{
+		uint32_t r = (i == 0) ? first : rand();
+
+		lanes[0][ r        & 0xFF]++;
+		lanes[1][(r >>  8) & 0xFF]++;
+		lanes[2][(r >> 16) & 0xFF]++;
+		lanes[3][ r >> 24        ]++;
+
+		ones += r >> 31;
+		if(i && ((r ^ prev) >> 31)) runs++;
+
+		double x = r * (1.0 / 4294967296.0);
+		double y = prev * (1.0 / 4294967296.0);
+		sum += x;
+		sum_sq += x * x;
+		if(i) sum_lag += x * y;
+
+		prev = r;
+	}
+	// Close the correlation loop, last sample pairs with the first
+	sum_lag += (prev * (1.0 / 4294967296.0)) * (first * (1.0 / 4294967296.0));
+	double took = (host_now_ns() - start) * 1e-9;
+
+	// Byte lanes
+	double expect = (double)samples / 256.0, chi2 = 0.0;
+	for(int l = 0; l < 4; l++)
+	{
+		for(int b = 0; b < 256; b++)
+		{
+			double d = lanes[l][b] - expect;
+			chi2 += d * d / expect;
+		}
+	}
+	snprintf(stat, sizeof(stat), "chi2=%.1f df=%d", chi2, 4 * 255);
+	fails += rng_report("rand() chi-square byte lanes", stat, chi2_p(chi2, 4 * 255), took);
+
+	// Wald-Wolfowitz runs of the MSB
+	double n = (double)samples, n1 = (double)ones, n0 = n - n1;
+	double mu  = 2.0 * n0 * n1 / n + 1.0;
+	double var = (mu - 1.0) * (mu - 2.0) / (n - 1.0);
+	double z   = (runs - mu) / sqrt(var);
+	snprintf(stat, sizeof(stat), "runs=%llu z=%.3f", (unsigned long long)runs, z);
+	fails += rng_report("rand() runs (MSB)", stat, z_p(z), took);
+
+	// Serial correlation, expected near 0 with a spread of 1/sqrt(n)
+	double corr = serial_corr(n, sum, sum_sq, sum_lag);
+	z = corr * sqrt(n);
+	snprintf(stat, sizeof(stat), "r=%+.6f z=%.3f", corr, z);
+	fails += rng_report("rand() serial correlation", stat, z_p(z), took);
+
+	return fails;
+}
+
+
+/// @brief Brent's cycle detection on the generator state. Finds the period
+/// the default seed falls into, or gives up after 2^limit_log2 steps
+static void test_period(const unsigned limit_log2)
+{
+	rng_reset();
+	const uint64_t limit = 1ULL << limit_log2;
+
+	double start = host_now_ns();
+	uint64_t power = 1, lam = 1, steps = 1;
+	uint64_t tortoise = rng_state();
+	(void)rand();
+
+	while(rng_state() != tortoise && steps < limit)
+	{
+		if(power == lam)
+		{
+			tortoise = rng_state();
+			power  <<= 1;
+			lam      = 0;
+		}
+
+		(void)rand();
+		lam++;
+		steps++;
+	}
+	double took = (host_now_ns() - start) * 1e-9;
+
+	if(rng_state() == tortoise)
+		printf("%-30s period=%-21llu %16s %8.3f s\n",
+		       "rand() period (Brent)", (unsigned long long)lam, "", took);
+	else
+		printf("%-30s period > 2^%-18u %16s %8.3f s\n",
+		       "rand() period (Brent)", limit_log2, "", took);
+}
+
+
+/// @brief Mean, range, chi-square over every value and serial correlation
+/// of int_rand() in one user mode
+static int test_mode(const user_mode_t mode, const uint64_t samples)
+{
+	static uint64_t bins[RNG_MAX_VALUES];
+	int fails = 0;
+	char name[64], stat[64];
+
+	host_firmware_reset(mode, 0x747AA32F);
+	rng_reset();
+
+	const int32_t  max   = g_mode->range;
+	const uint32_t range = 2 * (uint32_t)max + 1;
+	snprintf(name, sizeof(name), "int_rand() %s", host_mode_names[mode]);
+	if(max < 1 || range > RNG_MAX_VALUES)
+	{
+		printf("%-30s range +-%d is outside the suite's 1 - %d: FAIL\n",
+		       name, max, (RNG_MAX_VALUES - 1) / 2);
+		return 1;
+	}
+	for(uint32_t b = 0; b < range; b++) bins[b] = 0;
+	uint64_t outside = 0;
+
+	int32_t lo = max, hi = -max;
+	double sum = 0.0, sum_sq = 0.0, sum_lag = 0.0;
+
+	double start = host_now_ns();
+	int16_t first = int_rand(max), prev = first;
+	for(uint64_t i = 0; i < samples; i++)
+	{
+		int16_t v = (i == 0) ? first : int_rand(max);
+
+		// Anything past the range is counted, not binned
+		if(v < -max || v > max) outside++;
+		else                    bins[v + max]++;
+		if(v < lo) lo = v;
+		if(v > hi) hi = v;
+
+		sum += v;
+		sum_sq += (double)v * v;
+		if(i) sum_lag += (double)v * prev;
+
+		prev = v;
+	}
+	sum_lag += (double)prev * first;
+	double took = (host_now_ns() - start) * 1e-9;
+
+	// Everything average.py used to report
+	snprintf(stat, sizeof(stat), "mean=%+.4f min=%d max=%d", sum / samples, lo, hi);
+	printf("%-30s %-28s %-17s %8.3f s   (%.2f ns/call)\n",
+	       name, stat, "", took, took * 1e9 / samples);
+
+	// Every value should be equally likely
+	double expect = (double)samples / range, chi2 = 0.0;
+	for(uint32_t b = 0; b < range; b++)
+	{
+		double d = bins[b] - expect;
+		chi2 += d * d / expect;
+	}
+	if(lo != -max || hi != max || outside) fails++;
+	snprintf(name, sizeof(name), "  chi-square %u values", range);
+	snprintf(stat, sizeof(stat), "chi2=%.1f df=%u", chi2, range - 1);
+	fails += rng_report(name, stat, chi2_p(chi2, range - 1), took);
+
+	double corr = serial_corr((double)samples, sum, sum_sq, sum_lag);
+	double z = corr * sqrt((double)samples);
+	snprintf(stat, sizeof(stat), "r=%+.6f z=%.3f", corr, z);
+	fails += rng_report("  serial correlation", stat, z_p(z), took);
+
+	return fails;
+}
+
+
+
+/// @brief The int_rand() from before rand_range(). Masks rand() to one bit
+/// wider than the range, as the old per-mode masks did, then takes a modulo
+static int16_t int_rand_modulo(const int16_t max, const uint32_t mask)
+{
+	return (int16_t)((rand() & mask) % (2 * (uint32_t)max + 1)) - max;
+}
+
+
+/// @brief Compares the old mask-then-modulo int_rand() with rand_range() in
+/// one user mode. Reports the cost of each, in host time and rand() draws per
+/// value, and the bias of each, worked out and measured. Modulo is expected
+/// to be biased, so it is not counted as a failure
+static void test_modulo(const user_mode_t mode, const uint64_t samples)
+{
+	static uint64_t bins[RNG_MAX_VALUES];
+	char name[64], stat[64];
+
+	host_firmware_reset(mode, 0x747AA32F);
+
+	const int16_t  max   = g_mode->range;
+	const uint32_t range = 2 * (uint32_t)max + 1;
+	if(max < 1 || range > RNG_MAX_VALUES) return;
+
+	// Smallest power of two covering the range, and the old wider mask
+	uint32_t pow2 = 1;
+	while(pow2 < range) pow2 <<= 1;
+	const uint32_t mask = (pow2 << 1) - 1;
+
+	snprintf(name, sizeof(name), "int_rand() %s vs modulo", host_mode_names[mode]);
+	printf("%s\n", name);
+
+	for(int method = 0; method < 2; method++)
+	{
+		rng_reset();
+		for(uint32_t b = 0; b < range; b++) bins[b] = 0;
+
+		double start = host_now_ns();
+		for(uint64_t i = 0; i < samples; i++)
+		{
+			int16_t v = method ? int_rand(max) : int_rand_modulo(max, mask);
+			bins[v + max]++;
+		}
+		double took = (host_now_ns() - start) * 1e-9;
+
+		// Worked out - the modulo folds (mask + 1) values onto the range, so
+		// some values get one more than the rest. Rejection retries instead
+		uint32_t span  = method ? pow2 : mask + 1;
+		uint32_t each  = span / range;
+		double   bias  = (!method && span % range) ? 100.0 / each : 0.0;
+		double   draws = method ? (double)pow2 / range : 1.0;
+
+		// Measured - the furthest any value is from its fair share
+		double expect = (double)samples / range, chi2 = 0.0, worst = 0.0;
+		for(uint32_t b = 0; b < range; b++)
+		{
+			double d = bins[b] - expect;
+			chi2 += d * d / expect;
+			if(fabs(d) > worst) worst = fabs(d);
+		}
+
+		snprintf(name, sizeof(name), method ? "  rand_range()" : "  modulo, mask 0x%X", mask);
+		snprintf(stat, sizeof(stat), "%.2f draws, bias %.2f%% (%.2f%%)",
+		         draws, bias, 100.0 * worst / expect);
+		printf("%-30s %-40s p=%-9.4f %6.2f ns/call\n",
+		       name, stat, chi2_p(chi2, range - 1), took * 1e9 / samples);
+	}
+}
+
+
+
+/*** Main ********************************************************************/
+int main(int argc, char *argv[])
+{
+	uint64_t samples    = (argc > 1) ? strtoull(argv[1], NULL, 0) : RNG_DEFAULT_SAMPLES;
+	unsigned limit_log2 = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 0) : RNG_DEFAULT_PERIOD_LOG2;
+	if(samples < 2) samples = 2;
+	if(limit_log2 > 62) limit_log2 = 62;
+
+	printf("lib_rand quality suite: RANDOM_STRENGTH %d, %llu samples per test\n\n",
+	       RANDOM_STRENGTH, (unsigned long long)samples);
+
+	int fails = 0;
+	test_throughput(samples);
+	fails += test_rand_stream(samples);
+	test_period(limit_log2);
+
+	for(uint8_t m = 0; m < USER_MODE_COUNT; m++)
+	{
+		user_mode_plan_t plan = g_user_modes[m].plan;
+		if(plan == USER_MODE_PLAN_RANDOM || plan == USER_MODE_PLAN_COVER)
+			fails += test_mode((user_mode_t)m, samples);
+	}
+
+	// Bias is the most likely value against the least, then the furthest
+	// any value landed from its fair share in this run
+	printf("\n");
+	for(uint8_t m = 0; m < USER_MODE_COUNT; m++)
+	{
+		user_mode_plan_t plan = g_user_modes[m].plan;
+		if(plan == USER_MODE_PLAN_RANDOM || plan == USER_MODE_PLAN_COVER)
+			test_modulo((user_mode_t)m, samples);
+	}
+
+	printf("\n%d test(s) failed\n\n", fails);
+	return fails ? 1 : 0;
+}
@@ -0,0 +1,42 @@
+/******************************************************************************
+* Host stand-in for rv003usb.h - Used by the host-native benchmark only.
+* Declares the parts of the rv003usb API used by insomniac.c, the simulated
+* host poller provides them.
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#ifndef INSOMNIAC_HOST_RV003USB_H
+#define INSOMNIAC_HOST_RV003USB_H
+
+#include <stdint.h>
+
+struct usb_endpoint;
+struct rv003usb_internal;
+
+void usb_handle_user_in_request( struct usb_endpoint * e, uint8_t * scratchpad, int endp, uint32_t sendtok, struct rv003usb_internal * ist );
+
+void usb_send_data( const void * data, uint32_t length, uint32_t poly_function, uint32_t token );
+void usb_send_empty( uint32_t token );
+void usb_send_nak( void );
+void usb_setup();
+
+
+/// @brief Last packet sent by the firmware, and its length. 0 for an empty
+/// packet or a handshake. Provided by host_hw.c
+extern uint8_t   host_packet[8];
+extern uint32_t  host_packet_len;
+
+/// @brief PID of the last packet, the DATA0/DATA1 token it was sent with or
+/// HOST_PID_NAK
+#define HOST_PID_DATA0   0xC3
+#define HOST_PID_DATA1   0x4B
+#define HOST_PID_NAK     0x5A
+extern uint8_t   host_packet_pid;
+
+/// @brief DATA PID the simulated host expects next on the mouse endpoint. It
+/// ACKs every data packet, which flips it, like a real host. Data packets
+/// sent with the other PID are counted. Provided by host_hw.c
+extern uint8_t   host_expect_pid;
+extern uint32_t  host_toggle_errors;
+
+#endif
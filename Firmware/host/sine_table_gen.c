@@ -0,0 +1,33 @@
+/******************************************************************************
+* Generates the quarter-wave sine table used by mini_math.h, one entry per
+* degree from 0 to 90, in Q15. Run by make, which writes the output to
+* $(BUILD_DIR)/sine_table.h
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <math.h>
+
+#define SINE_TABLE_DEGREES    90
+#define SINE_TABLE_ONE        32768.0
+
+
+int main(void)
+{
+	printf("// Quarter-wave sine table, sin(n degrees) in Q15\n");
+	printf("// Generated by host/sine_table_gen.c - Do not edit\n");
+	printf("#ifndef INSOMNIAC_SINE_TABLE_H\n");
+	printf("#define INSOMNIAC_SINE_TABLE_H\n\n");
+	printf("#define SINE_TABLE_DEGREES    %d\n\n", SINE_TABLE_DEGREES);
+	printf("static const uint16_t sine_table[SINE_TABLE_DEGREES + 1] = {");
+
+	for(int deg = 0; deg <= SINE_TABLE_DEGREES; deg++)
+	{
+		long q15 = lround(sin(deg * M_PI / 180.0) * SINE_TABLE_ONE);
+		printf("%s%5ld%s", (deg % 10) ? " " : "\n\t", q15,
+		       (deg < SINE_TABLE_DEGREES) ? "," : "");
+	}
+
+	printf("\n};\n\n#endif\n");
+	return 0;
+}
@@ -0,0 +1,287 @@
+/******************************************************************************
+* Host decoder for the binary trace records of trace.h. Loads the format
+* strings from the .trace_fmt section of the firmware ELF, then reads the
+* bytes captured from the debug link, passing printf text straight through
+* and formatting each record with the string its ID points to.
+*
+* Build with:    make trace-decode
+* Run with:      ./build/trace_decode build/insomniac.elf [capture.bin]
+*                reads stdin when no capture file is given
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "trace.h"
+
+#define TRACE_SHF_ALLOC      0x2        // Section flag, occupies memory when run
+
+
+/// @brief Format strings from the ELF, indexed by ID
+typedef struct {
+	char             *strings;          // .trace_fmt, NUL terminated strings
+	uint32_t         size;
+} trace_table_t;
+
+
+/// @brief Decoder counts
+typedef struct {
+	uint64_t         records;
+	uint64_t         text;              // Bytes passed through
+	uint64_t         bad_id;            // Records with an unknown ID
+} trace_stats_t;
+
+
+
+/*** ELF *********************************************************************/
+/// @brief Reads a little endian field of an ELF header
+static uint64_t trace_elf_field(const uint8_t *p, const uint8_t bytes)
+{
+	uint64_t val = 0;
+	for(uint8_t b = bytes; b > 0; b--) val = (val << 8) | p[b - 1];
+	return val;
+}
+
+
+/// @brief Loads .trace_fmt from a little endian ELF32 or ELF64 file
+/// @param ELF path
+/// @param Table to fill
+/// @return 0 on success, -1 with a message on stderr otherwise
+static int trace_load_elf(const char *path, trace_table_t *table)
+{
+	FILE *elf = fopen(path, "rb");
+	if(!elf) { perror(path); return -1; }
+
+	fseek(elf, 0, SEEK_END);
+	long size = ftell(elf);
+	fseek(elf, 0, SEEK_SET);
+
+	uint8_t *img = malloc(size);
+	if(!img || fread(img, 1, size, elf) != (size_t)size)
+	{
+		fprintf(stderr, "%s: can't read\n", path);
+		fclose(elf);
+		free(img);
+		return -1;
+	}
+	fclose(elf);
+
+	if(size < 52 || memcmp(img, "\x7F" "ELF", 4) || img[5] != 1)
+	{
+		fprintf(stderr, "%s: not a little endian ELF file\n", path);
+		free(img);
+		return -1;
+	}
+
+	// Header and section header offsets for each class
+	uint8_t  wide      = (img[4] == 2);
+	uint8_t  addr      = wide ? 8 : 4;
+	uint64_t shoff     = trace_elf_field(img + (wide ? 0x28 : 0x20), addr);
+	uint32_t shentsize = trace_elf_field(img + (wide ? 0x3A : 0x2E), 2);
+	uint32_t shnum     = trace_elf_field(img + (wide ? 0x3C : 0x30), 2);
+	uint32_t shstrndx  = trace_elf_field(img + (wide ? 0x3E : 0x32), 2);
+	uint32_t off_pos   = wide ? 0x18 : 0x10;
+	uint32_t size_pos  = wide ? 0x20 : 0x14;
+
+	if(shoff + (uint64_t)shnum * shentsize > (uint64_t)size || shstrndx >= shnum)
+	{
+		fprintf(stderr, "%s: bad section headers\n", path);
+		free(img);
+		return -1;
+	}
+
+	const uint8_t *names = img + trace_elf_field(img + shoff + shstrndx * shentsize + off_pos, addr);
+
+	table->strings = NULL;
+	table->size    = 0;
+	for(uint32_t s = 0; s < shnum; s++)
+	{
+		const uint8_t *sh = img + shoff + s * shentsize;
+		if(strcmp((const char *)names + trace_elf_field(sh, 4), ".trace_fmt")) continue;
+
+		uint64_t flags = trace_elf_field(sh + 0x08, addr);
+		uint64_t vaddr = trace_elf_field(sh + (wide ? 0x10 : 0x0C), addr);
+		uint64_t off   = trace_elf_field(sh + off_pos, addr);
+		uint64_t len   = trace_elf_field(sh + size_pos, addr);
+		if(off + len > (uint64_t)size) break;
+
+		// The IDs are only offsets if the linker script put the strings at
+		// address 0, and left them out of flash
+		if((flags & TRACE_SHF_ALLOC) || vaddr != 0)
+		{
+			fprintf(stderr, "%s: .trace_fmt is %s, link with the .trace_fmt"
+			        " section of toolkit/ch32v003fun.ld\n", path,
+			        (flags & TRACE_SHF_ALLOC) ? "loaded to memory" : "not at address 0");
+			free(img);
+			return -1;
+		}
+
+		// One spare NUL, so a bad ID near the end still ends in a string
+		table->strings = malloc(len + 1);
+		memcpy(table->strings, img + off, len);
+		table->strings[len] = '\0';
+		table->size = (uint32_t)len;
+		break;
+	}
+
+	free(img);
+	if(!table->strings)
+	{
+		fprintf(stderr, "%s: no .trace_fmt section\n", path);
+		return -1;
+	}
+	return 0;
+}
+
+
+
+/*** Decoder *****************************************************************/
+/// @brief Formats a record like printf would have on the target. Each
+/// conversion is handed to fprintf with its flags and width, and the
+/// argument word cast to the type it expects
+static void trace_format(FILE *out, const char *fmt, const uint32_t *args, const uint8_t argc)
+{
+	uint8_t arg = 0;
+	char    spec[16];
+
+	while(*fmt)
+	{
+		// Literal text up to the next conversion
+		const char *pct = strchr(fmt, '%');
+		if(!pct) { fputs(fmt, out); return; }
+		fwrite(fmt, 1, pct - fmt, out);
+		fmt = pct + 1;
+
+		if(*fmt == '%') { fputc('%', out); fmt++; continue; }
+
+		// Flags, width and precision are kept, length modifiers dropped
+		size_t len = 0;
+		spec[len++] = '%';
+		while(*fmt && strchr("-+ #0123456789.", *fmt) && len < sizeof(spec) - 2)
+			spec[len++] = *fmt++;
+		while(*fmt == 'l' || *fmt == 'h' || *fmt == 'z') fmt++;
+
+		char conv = *fmt;
+		if(!conv) return;
+		fmt++;
+
+		uint32_t word = (arg < argc) ? args[arg] : 0;
+		arg++;
+
+		spec[len++] = conv;
+		spec[len]   = '\0';
+		switch(conv)
+		{
+			case 'd': case 'i': case 'c':
+				fprintf(out, spec, (int)(int32_t)word);
+				break;
+			case 'u': case 'x': case 'X': case 'o':
+				fprintf(out, spec, (unsigned int)word);
+				break;
+			default:
+				fprintf(out, "<%%%c 0x%08X>", conv, word);
+				break;
+		}
+	}
+}
+
+
+/// @brief Decodes a capture, text and records mixed
+/// @param Format strings
+/// @param Captured bytes
+/// @param Byte count
+/// @param Output
+/// @param Counts to add to
+/// @return Bytes used. A record cut off at the end is left for the next call
+static size_t trace_decode(const trace_table_t *table, const uint8_t *in, const size_t len,
+                           FILE *out, trace_stats_t *stats)
+{
+	size_t pos = 0;
+	while(pos < len)
+	{
+		// Text runs go out in one write
+		size_t run = pos;
+		while(run < len && in[run] < TRACE_HEADER) run++;
+		if(run > pos)
+		{
+			fwrite(in + pos, 1, run - pos, out);
+			stats->text += run - pos;
+			pos = run;
+			continue;
+		}
+
+		uint8_t argc = in[pos] - TRACE_HEADER;
+		if(argc > TRACE_MAX_ARGS)
+		{
+			// Not a header the firmware writes, pass it on
+			fputc(in[pos++], out);
+			stats->text++;
+			continue;
+		}
+
+		size_t rec_len = 3 + 4 * (size_t)argc;
+		if(pos + rec_len > len) break;
+
+		uint16_t id = in[pos + 1] | (in[pos + 2] << 8);
+		uint32_t args[TRACE_MAX_ARGS];
+		for(uint8_t a = 0; a < argc; a++)
+		{
+			const uint8_t *w = in + pos + 3 + 4 * a;
+			args[a] = w[0] | (w[1] << 8) | (w[2] << 16) | ((uint32_t)w[3] << 24);
+		}
+
+		if(id < table->size) trace_format(out, table->strings + id, args, argc);
+		else
+		{
+			fprintf(out, "<trace id 0x%04X>\n", id);
+			stats->bad_id++;
+		}
+
+		stats->records++;
+		pos += rec_len;
+	}
+
+	return pos;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(int argc, char **argv)
+{
+	if(argc < 2 || argc > 3)
+	{
+		fprintf(stderr, "Usage: %s firmware.elf [capture.bin]\n", argv[0]);
+		return 1;
+	}
+
+	trace_table_t table;
+	if(trace_load_elf(argv[1], &table)) return 1;
+
+	FILE *in = (argc == 3) ? fopen(argv[2], "rb") : stdin;
+	if(!in) { perror(argv[2]); return 1; }
+
+	// Keep any record cut off at the end of a read for the next one
+	static uint8_t buf[1 << 16];
+	size_t         kept = 0, got;
+	trace_stats_t  stats = {0};
+	while((got = fread(buf + kept, 1, sizeof(buf) - kept, in)) > 0)
+	{
+		size_t len  = kept + got;
+		size_t used = trace_decode(&table, buf, len, stdout, &stats);
+		kept = len - used;
+		memmove(buf, buf + used, kept);
+	}
+
+	fflush(stdout);
+	fprintf(stderr, "%llu record(s), %llu text byte(s), %llu unknown ID(s)%s\n",
+	        (unsigned long long)stats.records, (unsigned long long)stats.text,
+	        (unsigned long long)stats.bad_id, kept ? ", last record cut off" : "");
+
+	if(in != stdin) fclose(in);
+	free(table.strings);
+	return 0;
+}
@@ -0,0 +1,249 @@
+/******************************************************************************
+* Host test of the binary trace in trace.h and its decoder. Traces a set of
+* format strings through the debug printf ring to a simulated debugger,
+* mixed with plain printf text, then decodes the capture with the strings
+* from this program's own ELF and checks the text matches snprintf. Checks
+* a full ring drops whole records, so the decoder never loses its place.
+* Then times a trace call against formatting the same line, and the decoder
+* over a few million records.
+*
+* Build and run with:    make host-trace
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// debug_print.c replaces _write() and putchar() on the target, rename them
+// so the C library keeps its own. The decoder's main() is renamed too
+#define _write   debug_print_write
+#define putchar  debug_print_putchar
+#include "debug_print.c"
+#undef putchar
+#undef _write
+
+#include "trace.h"
+
+#define main trace_decode_main
+#include "trace_decode.c"
+#undef main
+
+
+/*** Test Settings ***********************************************************/
+#define TRACE_TEST_CAPTURE   65536      // Bytes of capture and reference text
+#define TRACE_TEST_TIMED     10000000   // Trace calls to time
+#define TRACE_TEST_RECORDS   4000000    // Records to time the decoder over
+#define TRACE_TEST_MIN_RATE  1.0e6      // Records per second the decoder needs
+
+
+// The Debug Module data registers
+volatile uint32_t host_dmdata[2];
+
+static uint8_t  trace_test_capture[TRACE_TEST_CAPTURE];
+static size_t   trace_test_capture_len;
+static char     trace_test_ref[TRACE_TEST_CAPTURE];
+static size_t   trace_test_ref_len;
+
+
+
+/*** Simulation **************************************************************/
+/// @brief Drains the ring into the capture, taking each packet like the
+/// debugger does
+static void trace_test_drain(void)
+{
+	while(debug_print_drain())
+	{
+		uint32_t d0  = host_dmdata[0];
+		uint32_t d1  = host_dmdata[1];
+		uint32_t len = (d0 & 0x7F) - 4;
+		for(uint32_t c = 0; c < len; c++)
+		{
+			uint32_t place = c + 1;
+			uint32_t word  = (place < 4) ? d0 : d1;
+			trace_test_capture[trace_test_capture_len++] = (uint8_t)(word >> ((place & 0x03) * 8));
+		}
+		host_dmdata[0] = 0x00;
+	}
+}
+
+
+/// @brief Traces a line, and writes what printf would have made of it to
+/// the reference
+#define TRACE_TEST(fmt, ...)                                                  \
+	do {                                                                      \
+		TRACE(fmt, ##__VA_ARGS__);                                            \
+		trace_test_ref_len += snprintf(trace_test_ref + trace_test_ref_len,   \
+		                               TRACE_TEST_CAPTURE - trace_test_ref_len, \
+		                               fmt, ##__VA_ARGS__);                   \
+		trace_test_drain();                                                   \
+	} while(0)
+
+
+/// @brief printf text, which goes through the ring as it is
+static void trace_test_text(const char *text)
+{
+	debug_print_write(0, text, strlen(text));
+	trace_test_ref_len += snprintf(trace_test_ref + trace_test_ref_len,
+	                               TRACE_TEST_CAPTURE - trace_test_ref_len, "%s", text);
+	trace_test_drain();
+}
+
+
+/// @brief Decodes the capture into a buffer
+/// @return Decoded length
+static size_t trace_test_decode(const trace_table_t *table, char *out, const size_t size,
+                                trace_stats_t *stats)
+{
+	FILE *mem = fmemopen(out, size, "w");
+	size_t used = trace_decode(table, trace_test_capture, trace_test_capture_len, mem, stats);
+	long   len  = ftell(mem);
+	fclose(mem);
+
+	return (used == trace_test_capture_len) ? (size_t)len : 0;
+}
+
+
+/// @brief Monotonic clock in ns
+static double trace_test_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	int fails = 0;
+
+	trace_table_t table;
+	if(trace_load_elf("/proc/self/exe", &table)) return 1;
+	printf("Trace test: %u bytes of format strings in .trace_fmt, %d byte ring\n\n",
+	       table.size, DEBUG_PRINT_RING_SIZE);
+
+	host_dmdata[0] = 0x00;
+
+	// Every kind of argument the decoder handles, and text between records
+	int32_t rng = -1;
+	trace_test_text("Insomniac trace\n");
+	TRACE_TEST("no arguments\n");
+	TRACE_TEST("%d\n", 0);
+	TRACE_TEST("%d\n", -2147483647 - 1);
+	TRACE_TEST("%u %x %X\n", 4294967295u, 0xDEADBEEFu, 0xCAFEu);
+	TRACE_TEST("[%6d] [%-6d] [%06d] [%+d]\n", -42, 42, 42, 7);
+	TRACE_TEST("%08lx %c%c\n", 0x1234ul, 'o', 'k');
+	TRACE_TEST("100%% of %d polls\n", 1000);
+	TRACE_TEST("%d,%u,%x\n", -1, 2u, 0xFFu);
+	trace_test_text("plain text, then four words:\n");
+	for(uint32_t n = 0; n < 200; n++)
+	{
+		rng = rng * 1103515245 + 12345;
+		TRACE_TEST("%d,%u,%x,%d\n", rng, (uint32_t)rng >> 7, n, -(int32_t)n);
+	}
+
+	static char decoded[TRACE_TEST_CAPTURE];
+	trace_stats_t stats = {0};
+	size_t len = trace_test_decode(&table, decoded, sizeof(decoded), &stats);
+	uint8_t match_ok = (len == trace_test_ref_len && !memcmp(decoded, trace_test_ref, len)
+	                 && stats.records == 208 && !stats.bad_id && !debug_print_dropped());
+	if(!match_ok) fails++;
+
+	printf("Decoded %llu records and %llu text bytes, %zu of %zu bytes match snprintf: %s\n",
+	       (unsigned long long)stats.records, (unsigned long long)stats.text,
+	       len, trace_test_ref_len, match_ok ? "PASS" : "FAIL");
+
+	// A debugger that isn't taking anything. Only whole records fit, the
+	// rest are dropped, and what's there still decodes
+	g_dbg_head = g_dbg_tail = 0;
+	g_dbg_dropped          = 0;
+	trace_test_capture_len = 0;
+	trace_test_ref_len     = 0;
+	host_dmdata[0]         = 0x80;
+
+	const uint32_t rec_len = 3 + 4 * 2;
+	const uint32_t fit     = DEBUG_PRINT_RING_SIZE / rec_len;
+	for(uint32_t n = 0; n < 100; n++)
+	{
+		TRACE("%u:%u\n", n, n * n);
+		if(n < fit)
+			trace_test_ref_len += snprintf(trace_test_ref + trace_test_ref_len,
+			                               TRACE_TEST_CAPTURE - trace_test_ref_len, "%u:%u\n", n, n * n);
+	}
+	uint32_t dropped = debug_print_dropped();
+	host_dmdata[0] = 0x00;
+	trace_test_drain();
+
+	memset(&stats, 0, sizeof(stats));
+	len = trace_test_decode(&table, decoded, sizeof(decoded), &stats);
+	uint8_t drop_ok = (stats.records == fit && dropped == (100 - fit) * rec_len
+	                && len == trace_test_ref_len && !memcmp(decoded, trace_test_ref, len));
+	if(!drop_ok) fails++;
+
+	printf("Full ring: kept %llu of 100 records, %u bytes dropped, decoded in step: %s\n",
+	       (unsigned long long)stats.records, dropped, drop_ok ? "PASS" : "FAIL");
+
+	// Target side cost. A trace call against formatting the same line and
+	// writing it to the ring, which is what printf does
+	volatile uint32_t sink = 0;
+	char   line[32];
+	double start = trace_test_now_ns();
+	for(uint32_t n = 0; n < TRACE_TEST_TIMED; n++)
+	{
+		g_dbg_tail = g_dbg_head;
+		TRACE("%d\n", (int32_t)n);
+	}
+	double trace_ns = (trace_test_now_ns() - start) / TRACE_TEST_TIMED;
+
+	start = trace_test_now_ns();
+	for(uint32_t n = 0; n < TRACE_TEST_TIMED; n++)
+	{
+		g_dbg_tail = g_dbg_head;
+		int l = snprintf(line, sizeof(line), "%d\n", (int32_t)n);
+		sink += debug_print_write(0, line, l);
+	}
+	double format_ns = (trace_test_now_ns() - start) / TRACE_TEST_TIMED;
+
+	printf("\nTRACE(\"%%d\\n\"): %.1f ns, snprintf and _write: %.1f ns, %.1fx\n",
+	       trace_ns, format_ns, format_ns / trace_ns);
+
+	// Decoder throughput over a long capture of one to four argument records
+	size_t   bulk_len = (size_t)TRACE_TEST_RECORDS * TRACE_RECORD_MAX;
+	uint8_t *bulk = malloc(bulk_len);
+	uint16_t ids[4];
+	const char *fmts[4] = {"%d\n", "%u:%u\n", "%d,%u,%x\n", "%d,%u,%x,%d\n"};
+	for(uint8_t f = 0; f < 4; f++)
+		for(uint32_t off = 0; off < table.size; off += strlen(table.strings + off) + 1)
+			if(!strcmp(table.strings + off, fmts[f])) ids[f] = (uint16_t)off;
+
+	size_t pos = 0;
+	for(uint32_t r = 0; r < TRACE_TEST_RECORDS; r++)
+	{
+		uint8_t argc = (r & 3) + 1;
+		bulk[pos++] = TRACE_HEADER | argc;
+		bulk[pos++] = (uint8_t)ids[argc - 1];
+		bulk[pos++] = (uint8_t)(ids[argc - 1] >> 8);
+		for(uint8_t a = 0; a < argc; a++, pos += 4) memcpy(bulk + pos, &r, 4);
+	}
+
+	FILE *null = fopen("/dev/null", "w");
+	memset(&stats, 0, sizeof(stats));
+	start = trace_test_now_ns();
+	trace_decode(&table, bulk, pos, null, &stats);
+	double rate = stats.records / ((trace_test_now_ns() - start) / 1e9);
+	fclose(null);
+	free(bulk);
+
+	uint8_t rate_ok = (stats.records == TRACE_TEST_RECORDS && !stats.bad_id
+	                && rate >= TRACE_TEST_MIN_RATE);
+	if(!rate_ok) fails++;
+
+	printf("Decoder: %.2f million records per second: %s\n", rate / 1e6, rate_ok ? "PASS" : "FAIL");
+
+	free(table.strings);
+	printf("\n%d check(s) failed\n\n", fails);
+	return fails ? 1 : 0;
+}
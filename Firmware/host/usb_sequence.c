@@ -0,0 +1,118 @@
+/******************************************************************************
+* Host test of the packet sequence on the mouse endpoint. Polls every row of
+* the User Mode Registry like a host would, keeping the DATA0/DATA1 toggle
+* the way rv003usb does - it only flips when the host ACKs a data packet.
+* Checks that every poll is answered with a full Report or a bare NAK, that
+* no Report is sent without movement, and that the data PIDs alternate
+* however many NAKs come between them. The PIDs are checked by the simulated
+* host in host_hw.c, against the one it expects next. Reports the share of
+* polls that needed a data transfer.
+*
+* Build and run with:    make host-usb
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+
+#include "host_firmware.h"
+
+
+/*** Test Settings ***********************************************************/
+#define USB_SEQ_SECONDS      120        // Simulated time per mode
+#define USB_SEQ_PASSES       4          // Main loop passes between polls
+#define USB_SEQ_SEED         0x747AA32F
+
+
+
+/// @brief Counts from one run
+typedef struct {
+	uint32_t         polls;
+	uint32_t         data;              // Data packets, ACKed by the host
+	uint32_t         naks;
+	uint32_t         bad_packet;        // Neither a full Report nor a NAK
+	uint32_t         idle_report;       // Reports without any movement
+	uint32_t         bad_toggle;        // Data PID out of sequence
+} usb_seq_result_t;
+
+
+
+/*** Simulation **************************************************************/
+/// @brief Runs one mode, polling like a host and checking every answer
+static usb_seq_result_t usb_seq_run(const user_mode_t mode)
+{
+	usb_seq_result_t res = {0};
+
+	host_firmware_reset(mode, USB_SEQ_SEED);
+
+	// rv003usb starts the endpoint on DATA0
+	uint8_t toggle = 0;
+
+	const uint32_t polls = USB_SEQ_SECONDS * 1000 / USB_POLL_INTERVAL_MS;
+	for(uint32_t p = 0; p < polls; p++)
+	{
+		for(uint32_t pass = 0; pass < USB_SEQ_PASSES; pass++) motion_task();
+
+		// IN token, with the PID usb_pid_handle_in() would pick
+		uint32_t sendtok = toggle ? HOST_PID_DATA1 : HOST_PID_DATA0;
+		host_packet_len = 0;
+		host_packet_pid = 0x00;
+		usb_handle_user_in_request(NULL, NULL, 1, sendtok, NULL);
+		res.polls++;
+
+		if(host_packet_pid == HOST_PID_NAK && host_packet_len == 0)
+		{
+			res.naks++;
+		}
+		else if((host_packet_pid == HOST_PID_DATA0 || host_packet_pid == HOST_PID_DATA1)
+		     && host_packet_len == REPORT_SIZE)
+		{
+			if(!host_packet[1] && !host_packet[2] && !host_packet[3]) res.idle_report++;
+
+			// The host ACKs, usb_pid_handle_ack() flips the toggle
+			res.data++;
+			toggle ^= 0x01;
+		}
+		else
+		{
+			res.bad_packet++;
+		}
+
+		DelaySysTick(Ticks_from_Ms(USB_POLL_INTERVAL_MS));
+	}
+
+	// Checked by the simulated host, against the PID it expected
+	res.bad_toggle = host_toggle_errors;
+	return res;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	int fails = 0;
+
+	printf("USB packet sequence test: %d s per mode, %d ms polls, idle NAK %s\n\n",
+	       USB_SEQ_SECONDS, USB_POLL_INTERVAL_MS, USB_IDLE_NAK ? "on" : "off");
+	printf("%-10s %8s %8s %8s %10s %12s %10s %10s  %s\n",
+	       "Mode", "polls", "data", "NAK", "data/h", "bad packet", "idle data",
+	       "bad toggle", "result");
+
+	for(uint8_t m = 0; m < USER_MODE_COUNT; m++)
+	{
+		usb_seq_result_t res = usb_seq_run((user_mode_t)m);
+
+		uint8_t ok = !res.bad_packet && !res.bad_toggle && res.data
+		          && (!USB_IDLE_NAK || !res.idle_report);
+		if(!ok) fails++;
+
+		printf("%-10s %8u %8u %8u %10.0f %12u %10u %10u  %s\n",
+		       host_mode_names[m], res.polls, res.data, res.naks,
+		       3600.0 * res.data / USB_SEQ_SECONDS,
+		       res.bad_packet, res.idle_report, res.bad_toggle,
+		       ok ? "PASS" : "FAIL");
+	}
+
+	printf("\n%d mode(s) failed\n\n", fails);
+	return fails ? 1 : 0;
+}
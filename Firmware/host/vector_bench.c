@@ -0,0 +1,204 @@
+/******************************************************************************
+* Host benchmark for vector moves. Compares the integer sine table path in
+* move_by_vector() against the archived float path (archive/mini_math.c
+* Taylor series) for every whole degree and a range of distances. Reports
+* how often each endpoint differs from the exactly rounded one, the worst
+* error, and the time per conversion. Then checks the lines it queues and
+* where it leaves the Virtual Cursor.
+* NOTE: The host has an FPU. On rv32ec every float operation is a libgcc
+* soft-float call, so the float path is far slower there than shown here.
+*
+* Build and run with:    make host-vector
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "host_firmware.h"
+
+// The archived float implementation
+#include "../archive/mini_math.c"
+
+
+/*** Benchmark Settings ******************************************************/
+#define VECTOR_MAX_DISTANCE   1000      // Distances 1 - MAX at every degree
+#define VECTOR_REPEATS        20        // Timing passes over every vector
+
+
+/// @brief Converts a vector to an endpoint
+typedef position_t (*vector_fn_t)(const euclid_vector_t);
+
+
+/// @brief Accuracy of one conversion path
+typedef struct {
+	uint64_t         vectors;
+	uint64_t         mismatched;        // Endpoints not exactly rounded
+	uint32_t         worst;             // Largest error on either axis
+	double           ns;                // Wall time per conversion
+} vector_result_t;
+
+
+
+/*** Conversion Paths ********************************************************/
+/// @brief Integer path, as used by move_by_vector()
+static position_t integer_vector(const euclid_vector_t vect)
+{
+	int32_t sin_q15, cos_q15;
+	mini_sincos(vect.angle, &sin_q15, &cos_q15);
+
+	return (position_t){
+		.x = mini_scale_q15(vect.distance, cos_q15),
+		.y = mini_scale_q15(vect.distance, sin_q15)
+	};
+}
+
+
+/// @brief Archived float path, from move_mouse_by_vector()
+static position_t float_vector(const euclid_vector_t vect)
+{
+	float angle_rad = vect.angle * (M_PI / 180.0);
+
+	return (position_t){
+		.x = mini_round(vect.distance * mini_cos(angle_rad)),
+		.y = mini_round(vect.distance * mini_sin(angle_rad))
+	};
+}
+
+
+/// @brief Exactly rounded endpoint, in double precision
+static position_t exact_vector(const euclid_vector_t vect)
+{
+	double angle_rad = vect.angle * (M_PI / 180.0);
+
+	return (position_t){
+		.x = (int16_t)lround(vect.distance * cos(angle_rad)),
+		.y = (int16_t)lround(vect.distance * sin(angle_rad))
+	};
+}
+
+
+
+/*** Benchmark ***************************************************************/
+/// @brief Checks a conversion path against the exact endpoint for every
+/// degree and distance, then times it
+static vector_result_t vector_run(const vector_fn_t fn)
+{
+	vector_result_t res = {0};
+
+	for(int16_t angle = 0; angle < 360; angle++)
+	{
+		for(uint16_t dist = 1; dist <= VECTOR_MAX_DISTANCE; dist++)
+		{
+			euclid_vector_t vect = {angle, dist};
+			position_t got = fn(vect);
+			position_t exp = exact_vector(vect);
+
+			uint32_t err_x = int_abs(got.x - exp.x);
+			uint32_t err_y = int_abs(got.y - exp.y);
+			if(err_x || err_y) res.mismatched++;
+			if(err_x > res.worst) res.worst = err_x;
+			if(err_y > res.worst) res.worst = err_y;
+			res.vectors++;
+		}
+	}
+
+	volatile int32_t sink = 0;
+	double start = host_now_ns();
+	for(int r = 0; r < VECTOR_REPEATS; r++)
+	{
+		for(int16_t angle = 0; angle < 360; angle++)
+		{
+			for(uint16_t dist = 1; dist <= VECTOR_MAX_DISTANCE; dist++)
+			{
+				position_t got = fn((euclid_vector_t){angle, dist});
+				sink += got.x + got.y;
+			}
+		}
+	}
+	res.ns = (host_now_ns() - start) / ((double)res.vectors * VECTOR_REPEATS);
+
+	return res;
+}
+
+
+/// @brief Checks move_by_vector() queues a line to the converted endpoint,
+/// moves the Virtual Cursor with it, and that turning the vector half way
+/// round brings the cursor back exactly, as Keep-Awake mode relies on
+static int check_move_by_vector(void)
+{
+	int fails = 0;
+
+	for(int16_t angle = -360; angle < 720; angle += 15)
+	{
+		euclid_vector_t vect = {angle, 100};
+		position_t exp = integer_vector(vect);
+
+		g_mi_buffer_head = 0;
+		g_mi_buffer_tail = 0;
+		g_cursor = (position_t){0, 0};
+		move_by_vector(vect);
+		if(g_cursor.x != exp.x || g_cursor.y != exp.y) fails++;
+
+		// Drain the line, summing the steps it takes
+		position_t sum = {0, 0};
+		mouse_instr_t instr;
+		while(mi_buffer_pop(&instr) == MI_BUFFER_OK)
+		{
+			position_t step = mouse_instr_delta(instr);
+			sum.x += step.x;
+			sum.y += step.y;
+		}
+
+		// Positive Y is queued as an Up instruction, which is -1 in a Report
+		if(sum.x != exp.x || sum.y != -exp.y) fails++;
+	}
+
+	for(int16_t angle = 0; angle < 360; angle++)
+	{
+		for(uint16_t dist = 1; dist <= 127; dist++)
+		{
+			g_mi_buffer_head = 0;
+			g_mi_buffer_tail = 0;
+			g_cursor = (position_t){0, 0};
+			move_by_vector((euclid_vector_t){angle,       dist});
+			move_by_vector((euclid_vector_t){angle + 180, dist});
+			if(g_cursor.x || g_cursor.y) fails++;
+		}
+	}
+
+	return fails;
+}
+
+
+
+/*** Main ********************************************************************/
+int main(void)
+{
+	printf("Vector move benchmark: 0 - 359 degrees, distance 1 - %d\n\n",
+	       VECTOR_MAX_DISTANCE);
+	printf("%-26s %12s %12s %8s %10s\n",
+	       "Path", "vectors", "mismatched", "worst", "ns/vector");
+
+	static const struct {
+		const char   *name;
+		vector_fn_t  fn;
+	} paths[] = {
+		{"Integer sine table (Q15)",  integer_vector},
+		{"Archived float Taylor",     float_vector},
+	};
+
+	for(size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++)
+	{
+		vector_result_t res = vector_run(paths[p].fn);
+		printf("%-26s %12llu %11.3f%% %8u %10.2f\n", paths[p].name,
+		       (unsigned long long)res.vectors, 100.0 * res.mismatched / res.vectors,
+		       res.worst, res.ns);
+	}
+
+	int fails = check_move_by_vector();
+	printf("\nmove_by_vector() queued lines and Virtual Cursor: %s\n\n", fails ? "FAIL" : "PASS");
+
+	return fails ? 1 : 0;
+}
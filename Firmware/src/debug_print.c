@@ -0,0 +1,129 @@
+/******************************************************************************
+* Non-Blocking Debug Printf over the SWIO Debug Link
+* See debug_print.h
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#include "ch32v003fun.h"
+#include "debug_print.h"
+
+#include "stdint.h"
+
+#if DEBUG_PRINT_RING
+
+/*** Static Variables ********************************************************/
+// Head and Tail count up forever and are masked on use, so head - tail is
+// the fill level and a full ring needs no spare slot. Only _write() moves
+// the head and only the drain moves the tail
+static uint8_t            g_dbg_ring[DEBUG_PRINT_RING_SIZE];
+static volatile uint16_t  g_dbg_head    = 0;
+static volatile uint16_t  g_dbg_tail    = 0;
+static volatile uint32_t  g_dbg_dropped = 0;
+
+// Keeps the compiler from moving the ring bytes past the index that
+// publishes them
+#define DEBUG_PRINT_BARRIER()  __asm__ volatile ("" ::: "memory")
+
+
+/// @brief Free bytes in the ring
+static inline uint32_t debug_print_room(void)
+{
+	return DEBUG_PRINT_RING_SIZE - (uint16_t)(g_dbg_head - g_dbg_tail);
+}
+
+
+/// @brief Copies bytes in at the head, then publishes them. The caller has
+/// checked they fit
+static inline void debug_print_put(const uint8_t *buf, const uint32_t len)
+{
+	uint16_t head = g_dbg_head;
+	for(uint32_t c = 0; c < len; c++)
+		g_dbg_ring[(head + c) & (DEBUG_PRINT_RING_SIZE - 1)] = buf[c];
+
+	DEBUG_PRINT_BARRIER();
+	g_dbg_head = head + len;
+}
+
+
+
+/*** Toolkit Overrides *******************************************************/
+// The toolkit's versions are weak, these replace them
+int _write(int fd, const char *buf, int size)
+{
+	(void)fd;
+
+	// Take what fits, drop the rest
+	uint32_t room = debug_print_room();
+	int take = (size > (int)room) ? (int)room : size;
+	if(take < size) g_dbg_dropped += (uint32_t)(size - take);
+
+	debug_print_put((const uint8_t *)buf, (uint32_t)take);
+	return take;
+}
+
+
+int putchar(int c)
+{
+	char chr = (char)c;
+	return _write(0, &chr, 1);
+}
+
+
+
+/*** Public Functions ********************************************************/
+uint32_t debug_print_drain(void)
+{
+	// DMDATA0: char3 char2 char1 [status]. Status bit 7 is set until the
+	// debugger takes the packet, and stays set with no debugger attached
+	if(*DMDATA0 & 0x80) return 0;
+
+	uint16_t tail  = g_dbg_tail;
+	uint16_t count = g_dbg_head - tail;
+	if(count == 0) return 0;
+	if(count > DEBUG_PRINT_PACKET) count = DEBUG_PRINT_PACKET;
+
+	// Bytes 1 - 3 go in DMDATA0 above the status, 4 - 7 in DMDATA1
+	uint32_t word[2] = {0x80 | (count + 4), 0};
+	for(uint16_t c = 0; c < count; c++)
+	{
+		uint8_t place = c + 1;
+		word[place >> 2] |= (uint32_t)g_dbg_ring[(tail + c) & (DEBUG_PRINT_RING_SIZE - 1)]
+		                    << ((place & 0x03) << 3);
+	}
+
+	DEBUG_PRINT_BARRIER();
+	g_dbg_tail = tail + count;
+
+	// The status goes last, it tells the debugger the packet is ready
+	*DMDATA1 = word[1];
+	*DMDATA0 = word[0];
+
+	return count;
+}
+
+
+uint32_t debug_print_record(const uint8_t *rec, const uint32_t len)
+{
+	if(len > debug_print_room())
+	{
+		g_dbg_dropped += len;
+		return 0;
+	}
+
+	debug_print_put(rec, len);
+	return len;
+}
+
+
+uint32_t debug_print_pending(void)
+{
+	return (uint16_t)(g_dbg_head - g_dbg_tail);
+}
+
+
+uint32_t debug_print_dropped(void)
+{
+	return g_dbg_dropped;
+}
+
+#endif
@@ -0,0 +1,70 @@
+/******************************************************************************
+* Non-Blocking Debug Printf over the SWIO Debug Link
+* Replaces the toolkit's _write() and putchar(), which wait on the debug
+* module data registers for every 7 bytes and stall the main loop, and the
+* USB timing with it, whenever a printf runs. Here they copy into a RAM ring
+* and return straight away. debug_print_drain() hands the ring to the
+* debugger 7 bytes at a time, only when the last packet has been taken, so
+* it never waits either. Bytes that don't fit in the ring are dropped and
+* counted, and with no debugger attached the ring just fills and drops.
+*
+* The ring has one writer and one reader. printf from the main loop only,
+* debug_print_drain() can be called from anywhere. Input from the host is
+* not read, handle_debug_input() is never called.
+*
+* Set DEBUG_PRINT_RING and DEBUG_PRINT_RING_SIZE in funconfig.h
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#ifndef INSOMNIAC_DEBUG_PRINT_H
+#define INSOMNIAC_DEBUG_PRINT_H
+
+#include <stdint.h>
+
+// Use the ring (1) or the toolkit's blocking debug printf (0)
+#ifndef DEBUG_PRINT_RING
+	#define DEBUG_PRINT_RING      1
+#endif
+
+// Bytes held for the debugger, must be a power of 2 (16 - 1024)
+#ifndef DEBUG_PRINT_RING_SIZE
+	#define DEBUG_PRINT_RING_SIZE 128
+#endif
+#if DEBUG_PRINT_RING_SIZE < 16 || DEBUG_PRINT_RING_SIZE > 1024 \
+ || (DEBUG_PRINT_RING_SIZE & (DEBUG_PRINT_RING_SIZE - 1))
+	#error "DEBUG_PRINT_RING_SIZE must be a power of 2 between 16 and 1024"
+#endif
+
+// Most bytes the debug link carries in one packet
+#define DEBUG_PRINT_PACKET       7
+
+
+
+/*** Function Declarations ***************************************************/
+/// @brief Passes up to DEBUG_PRINT_PACKET bytes from the ring to the
+/// debugger, if it has taken the last packet. Returns at once otherwise
+/// @param None
+/// @return Bytes passed on, 0 if the link is busy or the ring is empty
+uint32_t debug_print_drain(void);
+
+
+/// @brief Puts a whole record in the ring, or drops all of it if it won't
+/// fit, so a reader never sees part of one. Used by trace.h
+/// @param Record bytes
+/// @param Length, bytes
+/// @return Bytes put in the ring, len or 0
+uint32_t debug_print_record(const uint8_t *rec, const uint32_t len);
+
+
+/// @brief Bytes waiting in the ring for the debugger
+/// @param None
+/// @return Byte count, 0 - DEBUG_PRINT_RING_SIZE
+uint32_t debug_print_pending(void);
+
+
+/// @brief Bytes dropped because the ring was full, since power-on
+/// @param None
+/// @return Byte count
+uint32_t debug_print_dropped(void);
+
+#endif
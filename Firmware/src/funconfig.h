@@ -4,7 +4,59 @@
 #define CH32V003                 1
 #define FUNCONF_SYSTICK_USE_HCLK 1
 
-#define RANDOM_STRENGTH          2
+#ifndef RANDOM_STRENGTH
+	#define RANDOM_STRENGTH      2
+#endif
+
+// Steps packed into each HID Report, per axis (1 - 127)
+// Raised when a mode's speed needs more steps per poll than this
+#define REPORT_STEP_CAP          1
+
+// Host poll interval asked for in the Mouse endpoint descriptor, ms (1 - 255)
+// Speeds don't depend on it, the firmware measures the interval it really gets
+#define USB_POLL_INTERVAL_MS     10
+
+// Answer polls with nothing to send with a NAK (1), or an all-zero Report (0)
+#define USB_IDLE_NAK             1
+
+// Mode speeds, units (Mouse Instructions) per second (0 - 4000)
+// 0 is unlimited, moving as fast as the Report Cap allows
+#define RANDOM_SPEED             800
+#define STEPPED_SPEED            3
+#define PATTERN_SPEED            150
+
+// Time for random movements to ramp up to their speed, ms (0 - 1000)
+// They ramp down the same way to stop at the endpoint, 0 disables the ramp
+#define PROFILE_RAMP_MS          80
+
+// Endpoints of the random modes (Normal, Hi-Res, Jitter)
+// USER_MODE_PLAN_RANDOM picks independent random offsets, USER_MODE_PLAN_COVER
+// walks a Halton sequence, which covers the Virtual Cursor Box in fewer steps
+#define RANDOM_ENDPOINTS         USER_MODE_PLAN_RANDOM
+
+// Keep-Awake mode, seconds between nudges (1 - 3600) and nudge size in units
+// (1 - 127). The cursor goes out and straight back, with no movement between
+#define KEEP_AWAKE_PERIOD_S      30
+#define KEEP_AWAKE_NUDGE         1
+
+// Wheel mode, ticks scrolled out and back every KEEP_AWAKE_PERIOD_S (1 - 127)
+#define WHEEL_NUDGE              1
+
+// printf into a RAM ring of DEBUG_PRINT_RING_SIZE bytes, passed to the
+// debugger by the main loop without waiting (1), or the toolkit's blocking
+// debug printf (0). The ring drops what doesn't fit, so it can stay enabled.
+// It costs the ring and 8 Bytes of RAM, and with no debugger attached the
+// drain is one register read per loop. Turn it off with
+//   make EXTRA_CFLAGS=-DDEBUG_PRINT_RING=0
+#ifndef DEBUG_PRINT_RING
+	#define DEBUG_PRINT_RING     1
+#endif
+#define DEBUG_PRINT_RING_SIZE    128
+
+// Virtual Cursor Box, +- units from where the cursor was at power-on
+// Keeps the cursor away from screen edges, where the OS would clamp it
+#define CURSOR_BOUND_X           400
+#define CURSOR_BOUND_Y           300
 
 #endif
 
@@ -0,0 +1,99 @@
+/******************************************************************************
+* Low-Discrepancy Point Sequence for the Insomniac Motion Engine
+* Halton sequence in bases 2 and 3. Each new point falls in the largest gap
+* the earlier points left, so a path through them covers an area evenly,
+* where independent random points clump together and leave holes.
+*
+* Integer only. Each axis is the radical inverse of the point index, kept as
+* a Q0.16 fraction and updated digit by digit as the index counts up, so
+* there is no divide or multiply. The whole state is one halton_t, so the
+* sequence carries on from where it was left.
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#ifndef INSOMNIAC_HALTON_H
+#define INSOMNIAC_HALTON_H
+
+#include <stdint.h>
+
+// Digits of the index in each base. Base 2 repeats after 65536 points,
+// base 3 after 59049, far more than a box needs to be covered
+#define HALTON_DIGITS_X      16
+#define HALTON_DIGITS_Y      10
+
+/// @brief Position in the sequence
+typedef struct {
+	uint16_t         x;                     // Q0.16, base 2 radical inverse
+	uint16_t         y;                     // Q0.16, base 3 radical inverse
+	uint8_t          digit_x[HALTON_DIGITS_X];
+	uint8_t          digit_y[HALTON_DIGITS_Y];
+} halton_t;
+
+
+// Value of each digit place as a Q0.16 fraction, 65536 / base^(place + 1).
+// Base 3 is rounded down, so a full set of digits stays below 1.0
+static const uint16_t _halton_place_x[HALTON_DIGITS_X] = {
+	32768, 16384, 8192, 4096, 2048, 1024, 512, 256,
+	128,   64,    32,   16,   8,    4,    2,   1
+};
+
+static const uint16_t _halton_place_y[HALTON_DIGITS_Y] = {
+	21845, 7281, 2427, 809, 269, 89, 29, 9, 3, 1
+};
+
+
+
+/*** Sequence ****************************************************************/
+/// @brief Starts the sequence from its first point, index 0 at (0, 0)
+/// @param halton_t to reset
+/// @return None
+static inline void halton_init(halton_t *h)
+{
+	h->x = 0;
+	h->y = 0;
+	for(uint8_t d = 0; d < HALTON_DIGITS_X; d++) h->digit_x[d] = 0;
+	for(uint8_t d = 0; d < HALTON_DIGITS_Y; d++) h->digit_y[d] = 0;
+}
+
+
+/// @brief Adds one to an index written least significant digit first, and
+/// moves its radical inverse to match. A digit that wraps to 0 takes its
+/// place value back out and carries into the next
+/// @param Digits of the index
+/// @param Place values of the digits
+/// @param Number of digits
+/// @param Base
+/// @param Radical inverse of the index
+/// @return Radical inverse of the index + 1
+static inline uint16_t _halton_count(uint8_t *digit, const uint16_t *place,
+                                     const uint8_t digits, const uint8_t base,
+                                     uint16_t value)
+{
+	for(uint8_t d = 0; d < digits; d++)
+	{
+		if(++digit[d] < base) return value + place[d];
+
+		digit[d] = 0;
+		for(uint8_t n = 1; n < base; n++) value -= place[d];
+	}
+
+	// Every digit wrapped, the sequence starts again
+	return value;
+}
+
+
+/// @brief Moves to the next point of the sequence
+/// @param halton_t to advance
+/// @param Returned X, Q0.16 fraction of the width
+/// @param Returned Y, Q0.16 fraction of the height
+/// @return None
+static inline void halton_next(halton_t *h, uint16_t *x, uint16_t *y)
+{
+	h->x = _halton_count(h->digit_x, _halton_place_x, HALTON_DIGITS_X, 2, h->x);
+	h->y = _halton_count(h->digit_y, _halton_place_y, HALTON_DIGITS_Y, 3, h->y);
+
+	*x = h->x;
+	*y = h->y;
+}
+
+#endif
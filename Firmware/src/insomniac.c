@@ -16,7 +16,14 @@
 #include "ch32v003fun.h"
 #include "rv003usb.h"
 #include "lib_rand.h"
+#include "patterns.h"
+#include "halton.h"
+#include "mini_math.h"
+#include "recordings.h"
+#include "user_modes.h"
 #include "serial_uuid.h"
+#include "debug_print.h"
+#include "trace.h"
 
 //#include <stdio.h>          // NOTE: Comment out when net debugging
 
@@ -29,14 +36,55 @@ typedef struct {
 } position_t;
 
 
+/// @brief A Euclidian Vector, distance to travel at an angle. Angle is in
+/// degrees, anticlockwise from the +X axis
+typedef struct {
+	int16_t          angle;
+	uint16_t         distance;
+} euclid_vector_t;
+
+
 /// @brief Remapping of a uint8_t to movement instruction, 2 nibbles
 /// [Up    /   Down]  [Left  /  Right]
 ///  1100      0011    1100      0011
+/// Wheel ticks use the half patterns of Up and Down, which are never
+/// movement, so they queue in Line Segments like any other step
 typedef uint8_t mouse_instr_t;
 #define MOUSE_INSTR_U      0b11000000
 #define MOUSE_INSTR_D      0b00110000
 #define MOUSE_INSTR_L      0b00001100
 #define MOUSE_INSTR_R      0b00000011
+#define MOUSE_INSTR_WU     0b01000000
+#define MOUSE_INSTR_WD     0b00010000
+
+
+/// @brief Line Segment Descriptor. Holds the Bresenham state of a single line,
+/// which is expanded into Mouse Instructions one step at a time by the
+/// consumer, instead of storing every step in the buffer
+typedef struct {
+	int16_t          x_delta;       // Absolute X Distance of the line
+	int16_t          y_delta;       // Absolute Y Distance of the line
+	int16_t          err;           // Accumulated Bresenham Error
+	uint16_t         steps;         // Mouse Instructions left to expand
+	mouse_instr_t    x_instr;       // Instruction for an X Step
+	mouse_instr_t    y_instr;       // Instruction for a Y Step
+	mouse_instr_t    pending;       // Y Instruction held from a diagonal step
+} line_seg_t;
+
+
+/// @brief Acceleration Profile of the Line Segment being sent. Only the one
+/// at the Tail is ever moving, so its state is kept once rather than in every
+/// Line Segment, and cleared when the Tail moves on
+typedef struct {
+	uint32_t         speed;         // Q16.16 steps per Report
+	uint32_t         peak;          // Q16.16 speed this Line Segment cruises at
+	uint32_t         accel;         // Q16.16 speed added or removed each Report
+	uint32_t         brake;         // Q16.16 steps needed to stop from that speed
+	uint32_t         carry;         // Q16.16 steps earned but not sent yet
+	uint32_t         trim;          // Q16.16 added to each level while braking
+	uint8_t          levels;        // Speed levels from this one down to rest
+	uint8_t          braking;       // Set once the Line Segment slows down
+} profile_t;
 
 
 typedef enum {
@@ -46,33 +94,220 @@ typedef enum {
 } mi_buffer_status_t;
 
 
-// User Mode Selection from the Jumpers - Reads the jumpers in binary on boot
-typedef enum {
-	USER_MODE_NORMAL     = 0b000,
-	USER_MODE_HI_RES     = 0b001,
-	USER_MODE_JITTER     = 0b010,
-	USER_MODE_STEPPED    = 0b011
-} user_mode_t;
-
-
-
-
 /*** Globals *****************************************************************/
-// Ring Buffer Variables
-#define                 MI_BUFFER_SIZE   512
-static mouse_instr_t    g_mi_buffer[MI_BUFFER_SIZE];
+// Ring Buffer Variables - Holds Line Segments, not individual steps
+// NOTE: Must be a power of 2. At 32 ms polls, 4 Line Segments leave Pattern
+// mode 3.4% short of its speed, 8 keep it within 0.6% in 96 bytes. Try
+// others with  make host-bench EXTRA_HOST_CFLAGS="-DMI_BUFFER_SIZE=4
+// -DMI_BUFFER_LOW_WATER=3"
+// Low-Water Mark - The next line is planned while fewer than this many are
+// queued, so consecutive movements join without any idle Reports, and slow
+// polls have enough short pattern runs queued to fill a Report
+#ifndef MI_BUFFER_SIZE
+	#define             MI_BUFFER_SIZE   8
+#endif
+#ifndef MI_BUFFER_LOW_WATER
+	#define             MI_BUFFER_LOW_WATER   6
+#endif
+#if (MI_BUFFER_SIZE & (MI_BUFFER_SIZE - 1)) || MI_BUFFER_LOW_WATER >= MI_BUFFER_SIZE
+	#error "MI_BUFFER_SIZE must be a power of 2, above MI_BUFFER_LOW_WATER"
+#endif
+static line_seg_t       g_mi_buffer[MI_BUFFER_SIZE];
 volatile uint32_t       g_mi_buffer_head = 0;
 volatile uint32_t       g_mi_buffer_tail = 0;
 
 
-// Buffer is ready for another movement flag.
-// 0x00 Not Empty
-// 0x01 Empty
-volatile uint8_t        g_buffer_empty_flag = 0x00;
+// HID Report Mailbox - Double Buffered. Reports are composed ahead of time
+// by the main loop, the USB Interrupt only has to send the current slot.
+// A full slot is marked HOLD when its Report has no movement, which only
+// keeps the timing of the Acceleration Profile
+#define                 REPORT_SIZE      4
+#define                 REPORT_SLOT_SEND  0x01
+#define                 REPORT_SLOT_HOLD  0x02
+static uint8_t          g_report_mailbox[2][REPORT_SIZE];
+volatile uint8_t        g_report_full[2] = {0x00, 0x00};
+volatile uint8_t        g_report_read    = 0;
+static uint8_t          g_report_write   = 0;
+
+// Idle polls, and HOLD slots, are answered with a NAK like a real mouse with
+// nothing new to report, so the host has no transfer to wake up for. 0 sends
+// an all-zero Report instead. Set in funconfig.h
+#ifndef USB_IDLE_NAK
+	#define USB_IDLE_NAK     1
+#endif
+#if !USB_IDLE_NAK
+static uint8_t          g_report_idle[REPORT_SIZE] = {0x00, 0x00, 0x00, 0x00};
+#endif
+
+
+// Sub-pixel Velocity Accumulator - Speed in Q16.16 Mouse Instructions per
+// Report, 0 is unlimited and only the Report Cap applies. Every poll banks a
+// fraction of a step, and steps are only sent once they are banked.
+// The USB Interrupt counts the polls
+#define                 VELOCITY_ONE       0x00010000
+static uint32_t         g_velocity         = 0;
+static uint32_t         g_velocity_acc     = 0;
+volatile uint32_t       g_poll_count       = 0;
+static uint32_t         g_poll_seen        = 0;
+
+
+// Pacing - Hosts don't always poll at the bInterval asked for, so the poll
+// interval is measured, and each mode's speed in units per second is turned
+// into a Velocity for it. The USB Interrupt stamps each poll with the SysTick.
+// bInterval is set in funconfig.h
+#ifndef USB_POLL_INTERVAL_MS
+	#define USB_POLL_INTERVAL_MS   10
+#endif
+#if USB_POLL_INTERVAL_MS < 1 || USB_POLL_INTERVAL_MS > 255
+	#error "USB_POLL_INTERVAL_MS must be between 1 and 255"
+#endif
+#define                 PACE_SMOOTH_SHIFT  3        // Average of about 8 polls
+#define                 PACE_MAX_SPEED     4000     // Units per second
+volatile uint32_t       g_poll_tick        = 0;
+static uint32_t         g_poll_last_tick   = 0;
+static uint32_t         g_poll_period      = Ticks_from_Ms(USB_POLL_INTERVAL_MS);
+static uint32_t         g_pace_period      = 0;
+
+
+// Mode speeds in units (Mouse Instructions) per second. Set in funconfig.h
+#ifndef RANDOM_SPEED
+	#define RANDOM_SPEED      800
+#endif
+#ifndef STEPPED_SPEED
+	#define STEPPED_SPEED     3
+#endif
+#ifndef PATTERN_SPEED
+	#define PATTERN_SPEED     150
+#endif
+#if RANDOM_SPEED > PACE_MAX_SPEED || STEPPED_SPEED > PACE_MAX_SPEED || PATTERN_SPEED > PACE_MAX_SPEED
+	#error "Mode speeds must be between 0 and 4000 units per second"
+#endif
+
+
+// Acceleration Profile - Random movements ramp up to their speed over the
+// ramp time, then ramp down again to stop at the endpoint. Moves too short
+// to reach the speed turn back part way up the ramp. Each Line Segment takes
+// as long as it would with a smooth ramp, which the Pacing turns into whole
+// Reports. The time is kept in Q8 Reports, carrying what rounding gains or
+// loses to the next Line Segment, so the average speed doesn't depend on the
+// poll interval. 0 disables the profile. Set in funconfig.h
+#ifndef PROFILE_RAMP_MS
+	#define PROFILE_RAMP_MS   80
+#endif
+#if PROFILE_RAMP_MS < 0 || PROFILE_RAMP_MS > 1000
+	#error "PROFILE_RAMP_MS must be between 0 and 1000"
+#endif
+#define                 PROFILE_TIME_SLACK (2 << 8)  // Most time owed, Q8 Reports
+static uint32_t         g_profile_peak     = 0;
+static uint32_t         g_profile_ramp     = 0;      // Ramp time, Q8 Reports
+static uint32_t         g_profile_levels   = 0;      // Ramp time, whole Reports
+static uint32_t         g_profile_lag      = 0;      // Q8 Reports two ramps lose
+static uint32_t         g_profile_cruise   = 0;      // Shortest move to cruise
+static int32_t          g_profile_time     = 0;      // Q8 Reports left to spend
+static profile_t        g_profile          = {0};
+
+
+// Maximum steps packed into each HID Report, per axis. Set in funconfig.h
+// The limit is the most an int8_t axis can carry
+#define                 REPORT_STEP_LIMIT  127
+#ifndef REPORT_STEP_CAP
+	#define REPORT_STEP_CAP   1
+#endif
+#if REPORT_STEP_CAP < 1 || REPORT_STEP_CAP > REPORT_STEP_LIMIT
+	#error "REPORT_STEP_CAP must be between 1 and 127"
+#endif
+
+
+// Virtual Cursor Box - The firmware tracks where it has moved the cursor
+// since power-on, and keeps it within +-BOUND of the start. Set in funconfig.h
+#ifndef CURSOR_BOUND_X
+	#define CURSOR_BOUND_X    400
+#endif
+#ifndef CURSOR_BOUND_Y
+	#define CURSOR_BOUND_Y    300
+#endif
+
+// Virtual Cursor position, at the end of the last planned movement
+static position_t       g_cursor = {0, 0};
+
+
+// Coverage Walk - Random modes can sweep the Virtual Cursor Box instead of
+// picking independent offsets. The box is split into tiles the size of the
+// mode's range, which are visited in a serpentine, up and down the rows.
+// Each sweep puts the endpoint at a new point of a Halton sequence inside
+// every tile, so the sweeps fill the gaps left by the ones before, see
+// halton.h. Chosen for every random mode in funconfig.h
+#ifndef RANDOM_ENDPOINTS
+	#define RANDOM_ENDPOINTS  USER_MODE_PLAN_RANDOM
+#endif
+typedef struct {
+	halton_t         seq;
+	position_t       target;        // Endpoint being headed for
+	position_t       offset;        // Endpoint inside each tile, this sweep
+	int16_t          tile;          // Tile width and height
+	int16_t          cols;
+	int16_t          rows;
+	int16_t          col;
+	int16_t          row;
+	int8_t           col_dir;
+	int8_t           row_dir;
+} cover_walk_t;
+static cover_walk_t     g_cover;
+
+
+// Keep-Awake mode - Sends nothing for KEEP_AWAKE_PERIOD_S seconds, then
+// nudges the cursor out by the mode's range at a random angle and straight
+// back, just enough to reset the OS idle timer. Wheel mode scrolls
+// WHEEL_NUDGE ticks and back instead, so the pointer never moves. The seconds are counted off the
+// SysTick. Set in funconfig.h
+#ifndef KEEP_AWAKE_PERIOD_S
+	#define KEEP_AWAKE_PERIOD_S   30
+#endif
+#ifndef KEEP_AWAKE_NUDGE
+	#define KEEP_AWAKE_NUDGE      1
+#endif
+#if KEEP_AWAKE_PERIOD_S < 1 || KEEP_AWAKE_PERIOD_S > 3600
+	#error "KEEP_AWAKE_PERIOD_S must be between 1 and 3600"
+#endif
+#if KEEP_AWAKE_NUDGE < 1 || KEEP_AWAKE_NUDGE > 127
+	#error "KEEP_AWAKE_NUDGE must be between 1 and 127"
+#endif
+#ifndef WHEEL_NUDGE
+	#define WHEEL_NUDGE           1
+#endif
+#if WHEEL_NUDGE < 1 || WHEEL_NUDGE > 127
+	#error "WHEEL_NUDGE must be between 1 and 127"
+#endif
+static uint32_t         g_awake_tick   = 0;
+static uint16_t         g_awake_secs   = 0;
+
+
+// Pattern and Playback mode - The pattern or recording being traced around
+// the centre of the Virtual Cursor Box, and which one comes next. Runs of
+// identical steps are queued as one Line Segment, up to PATTERN_RUN_MAX long
+#define                 PATTERN_RUN_MAX      64
+#define                 PATTERN_MIN_RADIUS   50
+#define                 PATTERN_COUNT        5
+#if CURSOR_BOUND_X > PATTERN_MAX_RADIUS || CURSOR_BOUND_Y > PATTERN_MAX_RADIUS
+	#error "CURSOR_BOUND_X and CURSOR_BOUND_Y must be at most PATTERN_MAX_RADIUS"
+#endif
+static pattern_t        g_pattern;
+static uint8_t          g_pattern_next = 0;
+
+
+// User Mode Registry, see user_modes.h. The selected mode's settings are
+// copied into the globals above by user_mode_setup()
+static USER_MODE_TABLE(g_user_modes);
+
+// Path generator of the selected mode. Every row of the registry has its own,
+// with its plan and range built in as constants, picked by user_mode_setup()
+static void             (*g_plan)(void) = NULL;
 
 
 // User Settings Flags
-static user_mode_t   g_user_mode     = USER_MODE_NORMAL;
+static user_mode_t             g_user_mode  = USER_MODE_NORMAL;
+static const user_mode_desc_t  *g_mode      = &g_user_modes[USER_MODE_NORMAL];
+static int8_t                  g_report_cap = REPORT_STEP_CAP;
 
 
 
@@ -84,15 +319,75 @@ uint32_t int_abs(const int32_t x);
 
 
 /// @brief Generates a random signed integer, limited to a maximum range
-/// @param None
+/// @param Maximum, the value is from -range to +range
 /// @return int16_t integer
-int16_t int_rand(void);
+int16_t int_rand(const int16_t range);
+
+
+/// @brief Expands the next Mouse Instruction from a Line Segment, and
+/// advances its Bresenham state by one step
+/// @param Line Segment pointer, must have steps remaining
+/// @return Mouse Instruction
+mouse_instr_t line_seg_step(line_seg_t *seg);
+
+
+/// @brief Reflects a target co-ordinate back inside +-bound, so the
+/// Virtual Cursor bounces off the edges of its box instead of pinning there
+/// @param Target co-ordinate
+/// @param Bound of the box on this axis
+/// @return co-ordinate inside the box
+int16_t cursor_reflect(int32_t target, const int16_t bound);
+
 
+/// @brief Picks the next random endpoint relative to the Virtual Cursor,
+/// kept within the Virtual Cursor Box, then updates the Virtual Cursor
+/// @param Range of the offset on each axis
+/// @return position_t movement from the current Virtual Cursor position
+position_t plan_endpoint(const int16_t range);
 
-/// @brief Mouse Instruction Ring Buffer Push (Puts data in the buffer)
-/// @param Mouse Instruction
+
+/// @brief Sizes the Coverage Walk tiles for the mode's range, and starts the
+/// walk from the first tile. Uses libgcc divides, so only runs on setup
+/// @param None
+/// @return None
+void cover_setup(void);
+
+
+/// @brief Heads for the endpoint in the next tile of the Coverage Walk, no
+/// further than the mode's range on each axis. Starts a new sweep with the
+/// next Halton point after the last tile. Updates the Virtual Cursor
+/// @param None
+/// @return position_t movement from the current Virtual Cursor position
+position_t plan_cover(void);
+
+
+/// @brief Streams the next run of steps from the current pattern into the
+/// buffer. Once a pattern is finished, starts the next one and moves to its
+/// start point - a random size shape, or the next recording in Playback
+/// @param 0x01 to play the recordings, 0x00 for the shapes
+/// @return None
+void plan_pattern(const uint8_t playback);
+
+
+/// @brief Counts the seconds since the last Keep-Awake nudge, and queues the
+/// next one, out and back to where the cursor started, once they reach
+/// KEEP_AWAKE_PERIOD_S. Wheel mode nudges the wheel instead
+/// @param Nudge size, units or wheel ticks
+/// @param 0x01 to nudge the wheel, 0x00 the cursor
+/// @return None
+void plan_keep_awake(const int16_t nudge, const uint8_t wheel);
+
+
+/// @brief Mouse Instruction Ring Buffer Count
+/// @param None
+/// @return Number of Line Segments queued, including the one being expanded
+uint32_t mi_buffer_count(void);
+
+
+/// @brief Mouse Instruction Ring Buffer Push (Puts a Line Segment in the buffer)
+/// @param Line Segment pointer
 /// @return Mouse Instruction Status
-mi_buffer_status_t mi_buffer_push(const mouse_instr_t inst);
+mi_buffer_status_t mi_buffer_push(const line_seg_t *seg);
 
 
 /// @brief Mouse Instruction Ring Buffer Pop (Pulls off data from buffer)
@@ -113,19 +408,112 @@ mi_buffer_status_t mi_buffer_peek(mouse_instr_t *instr);
 mi_buffer_status_t mi_buffer_skip(void);
 
 
-/// @brief Plots movement to a given co-ordinate point. Appends the movement
-/// data to the circuilar buffer to be dispatched to the USB Interrupt
+/// @brief Applies the settings of the selected User Mode, after the jumpers
+/// have been read
+/// @param None
+/// @return None
+void user_mode_setup(void);
+
+
+/// @brief One pass of the main loop. Plans new movements and keeps the
+/// Report Mailbox filled. Never blocks
+/// @param None
+/// @return None
+void motion_task(void);
+
+
+/// @brief Composes one HID Mouse Report from the Mouse Instruction Buffer,
+/// packing as many steps as the Report Cap allows on each axis. Stops early
+/// if a step would reverse the direction of an axis
+/// @param Report buffer to populate, must be zeroed
+/// @return Mouse Instruction Status - No Data if the buffer is empty
+mi_buffer_status_t compose_report(uint8_t *buffer);
+
+
+/// @brief Picks how many steps of a Line Segment the next Report may carry.
+/// Trapezoidal profile - the fastest of one accel faster, the same or one
+/// accel slower that can still slow down by accel per Report and stop on
+/// the endpoint. The accel is fixed when the Line Segment starts, and the
+/// fraction of a step the speed earns is carried to the next Report
+/// @param line_seg_t at the Tail, to advance the profile of
+/// @return Whole steps allowed in the next Report
+uint8_t profile_speed(const line_seg_t *seg);
+
+
+/// @brief Works out how many Reports a Line Segment gets, from the time it
+/// takes with a smooth ramp and the time carried from the last one, then
+/// picks the peak and accel that fit its steps into those Reports
+/// @param line_seg_t that is about to start
+/// @return None
+void profile_start(const line_seg_t *seg);
+
+
+/// @brief Fills any free slots in the Report Mailbox with composed Reports.
+/// Slow modes leave the slots free until they have banked a whole step
+/// @param None
+/// @return None
+void report_mailbox_fill(void);
+
+
+/// @brief Measures the poll interval from the polls since the last call,
+/// rescales the speeds if it has drifted, then banks the movement earned by
+/// those polls in the Velocity Accumulator
+/// @param None
+/// @return None
+void velocity_update(void);
+
+
+/// @brief Turns the mode's speed and ramp time into a Velocity, peak and
+/// accel per Report at the measured poll interval. Uses libgcc divides, so
+/// only runs when the interval changes
+/// @param None
+/// @return None
+void pacing_scale(void);
+
+
+/// @brief Plots movement to a given co-ordinate point, relative to the current
+/// position. Appends a Line Segment to the circuilar buffer to be expanded
+/// and dispatched by the USB Interrupt
 /// @param postion_t endpoint to plot to. Contains X/Y data, can be positive
 /// or negative
 /// @return Mouse Inscription buffer status - if push fails
 mi_buffer_status_t move_to_endpoint(const position_t endpoint);
 
 
-/// @brief sets HID mouse bytes from an input Mouse Movement Instruction
-/// @param buffer to modify
+/// @brief Queues wheel ticks as a Line Segment, which are sent one per
+/// Report while the Report Cap is 1. The pointer doesn't move
+/// @param Ticks to scroll, positive is away from the user
+/// @return Mouse Inscription buffer status - if push fails
+mi_buffer_status_t move_wheel(const int16_t ticks);
+
+
+/// @brief Plots movement of a distance at an angle, relative to the current
+/// position. Converts the vector to an endpoint using the integer sine
+/// table, then moves to it like move_to_endpoint(). The Virtual Cursor
+/// follows the move, it is not kept inside its box
+/// @param euclid_vector_t to move by. Distance 0 - 32767
+/// @return Mouse Inscription buffer status - if push fails
+mi_buffer_status_t move_by_vector(const euclid_vector_t vect);
+
+
+/// @brief Converts a Mouse Movement Instruction to its HID X/Y Delta
 /// @param instruction to parse
-/// @return None
-void set_mouse_instr_bytes(uint8_t *buffer, mouse_instr_t instr);
+/// @return position_t delta, -1, 0 or 1 on each axis
+position_t mouse_instr_delta(const mouse_instr_t instr);
+
+
+/// @brief Converts a Mouse Instruction to its HID Wheel Delta
+/// @param instruction to parse
+/// @return int16_t delta, -1, 0 or 1
+int16_t mouse_instr_wheel(const mouse_instr_t instr);
+
+
+/// @brief Checks if a step can be added to an axis of a Report without
+/// exceeding the Report Cap or reversing direction
+/// @param Accumulated axis delta
+/// @param Step delta, -1, 0 or 1
+/// @return 0x01 if the step fits, 0x00 otherwise
+uint8_t report_axis_fits(const int16_t acc, const int16_t step);
 
 
 
@@ -166,6 +554,7 @@ int main(void)
 	if(!((GPIOA->INDR >> 2) & 0x01)) g_user_mode |= 0x01;      // JP1 PA2
 	if(!((GPIOA->INDR >> 1) & 0x01)) g_user_mode |= 0x02;      // JP2 PA1
 	if(!((GPIOC->INDR >> 4) & 0x01)) g_user_mode |= 0x04;      // JP3 PC4
+	user_mode_setup();
 
 
 	/*** USB ****************************/
@@ -176,25 +565,16 @@ int main(void)
 
 	while(1) 
 	{
-		// NOTE: Prints random values to evaluate random number algorithm
-		//printf("%d\n", int_rand());
+		// NOTE: Traces random values to evaluate random number algorithm.
+		// make trace-decode formats the capture on the host
+		//TRACE("%d\n", int_rand(g_mode->range));
 
-		// Wait for the flag that the buffer is empty
-		if(g_buffer_empty_flag)
-		{
-			// Generate a random position then push the commands to move to it
-			position_t rand_pos = {.x = int_rand(), .y = int_rand()};
-			move_to_endpoint(rand_pos);
-
-			// Reset the empty flag, waits until it is done moving
-			g_buffer_empty_flag = 0x00;			
-		}
-
-
-		// Add a delay for Calm mode to increase usability
-		if(g_user_mode == USER_MODE_STEPPED)
-			Delay_Ms(5000);
+		motion_task();
 
+#if DEBUG_PRINT_RING
+		// Pass any printf output on to the debugger, if it is ready
+		debug_print_drain();
+#endif
 	} 
 	// end of loop
 	
@@ -205,137 +585,662 @@ int main(void)
 
 
 /*** Functions ***************************************************************/
+/// @brief Plans the next movement of a mode. Inlined into a planner for each
+/// row of the registry with the plan and range as constants, so the switch
+/// folds away and each planner is only its own path
+static inline __attribute__((always_inline))
+void plan_mode(const user_mode_plan_t plan, const int16_t range)
+{
+	switch(plan)
+	{
+		case USER_MODE_PLAN_RANDOM:      move_to_endpoint(plan_endpoint(range));  break;
+		case USER_MODE_PLAN_COVER:       move_to_endpoint(plan_cover());          break;
+		case USER_MODE_PLAN_PATTERN:     plan_pattern(0x00);                      break;
+		case USER_MODE_PLAN_PLAYBACK:    plan_pattern(0x01);                      break;
+		case USER_MODE_PLAN_KEEP_AWAKE:  plan_keep_awake(range, 0x00);            break;
+		case USER_MODE_PLAN_WHEEL:       plan_keep_awake(range, 0x01);            break;
+	}
+}
+
+#define USER_MODE_PLANNER(name, jumpers, range, speed, ramp, cap, plan) \
+	static void plan_mode_##name(void) { plan_mode(plan, range); }
+USER_MODE_LIST(USER_MODE_PLANNER)
+#undef USER_MODE_PLANNER
+
+#define USER_MODE_PLANNER_ROW(name, jumpers, range, speed, ramp, cap, plan) \
+	[jumpers] = plan_mode_##name,
+static void (*const g_user_mode_plans[USER_MODE_COUNT])(void) = {
+	USER_MODE_LIST(USER_MODE_PLANNER_ROW)
+};
+#undef USER_MODE_PLANNER_ROW
+
+
+void user_mode_setup(void)
+{
+	g_mode = &g_user_modes[g_user_mode & (USER_MODE_COUNT - 1)];
+	g_plan = g_user_mode_plans[g_user_mode & (USER_MODE_COUNT - 1)];
+
+	if(g_mode->plan == USER_MODE_PLAN_COVER) cover_setup();
+
+	// The first nudge is a whole period away
+	g_awake_tick = SysTick->CNT;
+	g_awake_secs = 0;
+
+	g_velocity_acc = 0;
+	g_poll_seen    = g_poll_count;
+	g_profile_time = 0;
+	g_profile      = (profile_t){0};
+
+	// Scale the mode's speeds for the last measured poll interval
+	pacing_scale();
+}
+
+
+void motion_task(void)
+{
+	// Plan the next movement while the current one is still draining
+	if(mi_buffer_count() < MI_BUFFER_LOW_WATER)
+	{
+		// Generate a random position then push the commands to move to it,
+		// or carry on tracing the current pattern
+		g_plan();
+	}
+
+	// Keep the Report Mailbox topped up for the USB Interrupt
+	report_mailbox_fill();
+}
+
+
 // rv003usb HID Function
 void usb_handle_user_in_request( struct usb_endpoint * e, uint8_t * scratchpad, int endp, uint32_t sendtok, struct rv003usb_internal * ist )
 {
-	static mouse_instr_t crnt_mouse_instr;
-	static mouse_instr_t next_mouse_instr;
-
 	// Handle the USB Mouse messages
 	if(endp == 1)
 	{
-		// Define an empty mouse bytes array
-		uint8_t mouse_bytes[4] = {0x00, 0x00, 0x00, 0x00};
-
-		// Get the current and next data chunks
-		mi_buffer_status_t crnt_buffer_status = mi_buffer_pop(&crnt_mouse_instr);
-		mi_buffer_status_t next_buffer_status = mi_buffer_peek(&next_mouse_instr);
+		uint8_t slot = g_report_read;
+		g_poll_tick = SysTick->CNT;
+		g_poll_count++;
 
-		// If the current status is OK, set the data bytes
-		if(crnt_buffer_status == MI_BUFFER_OK)
+		// Send the pre-composed Report if one is ready, then free its slot
+		if(g_report_full[slot])
 		{
-			set_mouse_instr_bytes(mouse_bytes, crnt_mouse_instr);
+			if(USB_IDLE_NAK && g_report_full[slot] == REPORT_SLOT_HOLD) usb_send_nak();
+			else usb_send_data(g_report_mailbox[slot], REPORT_SIZE, 0, sendtok);
+
+			g_report_full[slot] = 0x00;
+			g_report_read       = slot ^ 0x01;
 		}
 
-		// If it's empty, set the flag and leave the buffer unset
+		// Otherwise there is no movement, NAK or send 0x00's
 		else
 		{
-			g_buffer_empty_flag = 0x01;
+#if USB_IDLE_NAK
+			usb_send_nak();
+#else
+			usb_send_data(g_report_idle, REPORT_SIZE, 0, sendtok);
+#endif
 		}
+	}
+	else
+	{
+		// If it's a control transfer, empty it.
+		usb_send_empty(sendtok);
+	}
+}
+
+
+mi_buffer_status_t compose_report(uint8_t *buffer)
+{
+	position_t    report = {0, 0};
+	int16_t       wheel  = 0;
+	mouse_instr_t mouse_instr;
+
+	// Exit if there is nothing to send
+	if(mi_buffer_peek(&mouse_instr) != MI_BUFFER_OK) return MI_BUFFER_NO_DATA;
+
+	// Profiled modes limit the total steps, not just each axis
+	uint32_t tail = g_mi_buffer_tail;
+	uint8_t budget = 0xFF;
+	if(g_profile_peak) budget = profile_speed(&g_mi_buffer[tail]);
+	uint8_t allowed = budget;
 
+	// Pack steps into the Report until the next one doesn't fit. Alternating
+	// X and Y steps become diagonal movement
+	do {
+		position_t step = mouse_instr_delta(mouse_instr);
+		int16_t    tick = mouse_instr_wheel(mouse_instr);
 
-		// If the next instruction is valid, parse it (Allows for diagonal movement)
-		if(next_buffer_status == MI_BUFFER_OK)
+		if(!report_axis_fits(report.x, step.x)
+		|| !report_axis_fits(report.y, step.y)
+		|| !report_axis_fits(wheel, tick)) break;
+
+		if(budget == 0) break;
+
+		// Only move as far as has been banked
+		if(g_velocity)
 		{
-			// If this instruction is LEFT or RIGHT, and the previous was UP or DOWN,
-			// add this instruction to the data
-			if((next_mouse_instr == MOUSE_INSTR_L || next_mouse_instr == MOUSE_INSTR_R)
-			&& (crnt_mouse_instr == MOUSE_INSTR_U || crnt_mouse_instr == MOUSE_INSTR_D))
-			{
-				set_mouse_instr_bytes(mouse_bytes, next_mouse_instr);
-				mi_buffer_skip();
-			}
+			if(g_velocity_acc < VELOCITY_ONE) break;
+			g_velocity_acc -= VELOCITY_ONE;
+		}
+
+		budget--;
+		report.x += step.x;
+		report.y += step.y;
+		wheel    += tick;
+		mi_buffer_skip();
+	} while(mi_buffer_peek(&mouse_instr) == MI_BUFFER_OK);
+
+	// Spend the whole steps sent from the profile's carry. A finished Line
+	// Segment has already cleared the profile for the next one
+	if(g_profile_peak && g_mi_buffer_tail == tail)
+		g_profile.carry -= (uint32_t)(allowed - budget) << 16;
+
+	// signed 8 bit ints for movement, using Unsigned representation
+	buffer[1] = (uint8_t)report.x;
+	buffer[2] = (uint8_t)report.y;
+	buffer[3] = (uint8_t)wheel;
+
+	return MI_BUFFER_OK;
+}
+
+
+void report_mailbox_fill(void)
+{
+	velocity_update();
+
+	// Fill slots until the Mailbox is full, or there is nothing left to send
+	while(!g_report_full[g_report_write])
+	{
+		// Not a whole step banked yet, send nothing this poll
+		if(g_velocity && g_velocity_acc < VELOCITY_ONE) return;
+
+		uint8_t *report = g_report_mailbox[g_report_write];
+		report[0] = 0x00;  report[1] = 0x00;  report[2] = 0x00;  report[3] = 0x00;
+
+		// If the buffer is empty, leave the slot free
+		if(compose_report(report) != MI_BUFFER_OK) return;
+
+		// Make sure the Report is written before the Interrupt can see it
+		__asm__ volatile("" ::: "memory");
+		g_report_full[g_report_write] = (report[1] | report[2] | report[3])
+		                              ? REPORT_SLOT_SEND : REPORT_SLOT_HOLD;
+		g_report_write ^= 0x01;
+	}
+}
+
+
+uint8_t profile_speed(const line_seg_t *seg)
+{
+	// Speeds are taken mid-Report, so the levels run accel/2, accel * 3/2 ...
+	// brake is the sum of the levels from the current one down to accel/2,
+	// kept up to date by adding or removing one level, so no multiply is
+	// needed. left is how far there is still to go, less the fraction of a
+	// step already earned
+	// The accel is never 0 once the Line Segment has started
+	if(g_profile.accel == 0) profile_start(seg);
+	uint32_t speed = g_profile.speed;
+	uint32_t accel = g_profile.accel;
+	uint32_t left  = ((uint32_t)seg->steps << 16) - g_profile.carry;
+
+	// Every Report spends one of the Reports the Line Segment was given
+	g_profile_time -= 1 << 8;
+
+	if(!g_profile.braking)
+	{
+		uint32_t step = speed ? accel : (accel >> 1);
+
+		// Room to speed up and still stop in time
+		if(speed + step <= g_profile.peak && left >= g_profile.brake + speed + step)
+		{
+			speed += step;
+			g_profile.brake += speed;
+			g_profile.levels++;
+		}
+
+		// Lines shorter than half an accel step go in one Report, as the
+		// last level
+		else if(speed == 0)
+		{
+			g_profile.braking = 0x01;
+			g_profile.levels  = 1;
+		}
 
-			// Likewise with UP and DOWN, append if last instruction was LEFT or RIGHT
-			if((next_mouse_instr == MOUSE_INSTR_U || next_mouse_instr == MOUSE_INSTR_D)
-			&& (crnt_mouse_instr == MOUSE_INSTR_L || crnt_mouse_instr == MOUSE_INSTR_R))
+		// Short of room to speed up, or to cruise for another Report, start
+		// slowing down. Drop a level first if this one would overshoot, then
+		// spread whatever is left over the levels evenly across them, like
+		// starting to brake part way through a Report
+		else if(speed + accel <= g_profile.peak || left < g_profile.brake + speed)
+		{
+			g_profile.braking = 0x01;
+			if(left < g_profile.brake && g_profile.levels > 1)
 			{
-				set_mouse_instr_bytes(mouse_bytes, next_mouse_instr);
-				mi_buffer_skip();
+				g_profile.brake -= speed;
+				speed -= accel;
+				g_profile.levels--;
 			}
+			if(left > g_profile.brake)
+				g_profile.trim = (left - g_profile.brake) / g_profile.levels;
 		}
-		
+	}
+	else if(g_profile.levels > 1)
+	{
+		g_profile.brake -= speed;
+		speed -= accel;
+		g_profile.levels--;
+	}
+
+	g_profile.speed = speed;
 
-		// Send the data to the USB Controller - Either 0x00's or has Delta data
-		usb_send_data(mouse_bytes, 4, 0, sendtok);
+	// The last level finishes the Line Segment exactly. Whatever a Report
+	// can't carry is left for the next, still on the last level
+	uint32_t steps = seg->steps;
+	if(!(g_profile.braking && g_profile.levels <= 1))
+	{
+		g_profile.carry += speed + g_profile.trim;
+		steps = g_profile.carry >> 16;
 	}
-	else
+	return (steps > REPORT_STEP_LIMIT) ? REPORT_STEP_LIMIT : (uint8_t)steps;
+}
+
+
+void profile_start(const line_seg_t *seg)
+{
+	// Time at the mode's speed, in Q8 Reports. Split in two divides so
+	// nothing overflows 32 bits
+	uint32_t steps = seg->steps;
+	uint32_t whole = (steps << 16) / g_profile_peak;
+	uint32_t part  = (steps << 16) % g_profile_peak;
+	uint32_t time  = (whole << 8) + ((part << 8) / g_profile_peak);
+
+	// A smooth ramp up and back down loses half a ramp each way. Moves too
+	// short to cruise take 2 sqrt(steps / accel), and accel is speed / ramp
+	if(steps >= g_profile_cruise) {
+		time += g_profile_ramp;
+	} else if(g_profile_ramp < (1UL << 16)) {
+		time = mini_sqrt(time * g_profile_ramp) << 1;
+	} else {
+		time = mini_sqrt((time >> 8) * (g_profile_ramp >> 8)) << 9;
+	}
+
+	// Whole Reports for this Line Segment, with the time carried from the
+	// last. Owing more than the slack means the moves can't get any shorter
+	if(g_profile_time < -PROFILE_TIME_SLACK) g_profile_time = -PROFILE_TIME_SLACK;
+	g_profile_time += time;
+	int32_t reports = (g_profile_time + (1 << 7)) >> 8;
+	if(reports < 1)      reports = 1;
+	if(reports > 0xFFFF) reports = 0xFFFF;
+
+	uint32_t levels = g_profile_levels;
+	if((uint32_t)reports >= (levels << 1))
 	{
-		// If it's a control transfer, empty it.
-		usb_send_empty(sendtok);
+		// Ramp up and down over the set levels, cruising between them at the
+		// speed that finishes on time. Two ramps take lag Reports longer than
+		// cruising the whole way
+		uint32_t span = ((uint32_t)reports << 8) - g_profile_lag;
+		whole = (steps << 16) / span;
+		part  = (steps << 16) % span;
+		g_profile.peak  = (whole << 8) + ((part << 8) / span);
+		g_profile.accel = (g_profile.peak << 1) / ((levels << 1) - 1);
+	} else {
+		// Turn back part way up. With the levels at accel/2, accel * 3/2 ...
+		// half the Reports up and half down cover accel * (reports / 2)^2
+		g_profile.peak  = ((steps << 16) / (uint32_t)reports) << 1;
+		g_profile.accel = (g_profile.peak << 1) / (uint32_t)reports;
 	}
+	if(g_profile.accel < 2) g_profile.accel = 2;
 }
 
 
-void set_mouse_instr_bytes(uint8_t buffer[], mouse_instr_t instr)
+void velocity_update(void)
 {
-	// signed 8 bit ints for movement, using Unsigned representation
-	// [1] is (0xFF)L  (0x01)R
-	// [2] is (0xFF)U  (0x01)D
+	// Polls since the last update, and when the last one came. The Interrupt
+	// writes the tick then the count, so read both again if a poll came in
+	// between. Masking the Interrupt instead would delay the USB bit timing
+	uint32_t count, tick;
+	do {
+		count = g_poll_count;
+		tick  = g_poll_tick;
+	} while(count != g_poll_count);
+
+	uint32_t polls = count - g_poll_seen;
+	if(polls == 0) return;
+	g_poll_seen = count;
+
+	// A single new poll measures one interval, the very first has nothing
+	// to measure from. Clamp each measurement to half or double the average,
+	// so a stall only nudges it
+	if(polls == 1 && g_poll_seen != 1)
+	{
+		uint32_t interval = tick - g_poll_last_tick;
+		if(interval > (g_poll_period << 1)) interval = g_poll_period << 1;
+		if(interval < (g_poll_period >> 1)) interval = g_poll_period >> 1;
+
+		g_poll_period += ((int32_t)(interval - g_poll_period)) >> PACE_SMOOTH_SHIFT;
+	}
+	g_poll_last_tick = tick;
+
+	// Rescale once the interval has drifted by more than 1/256
+	if(int_abs((int32_t)(g_poll_period - g_pace_period)) > (g_pace_period >> 8))
+		pacing_scale();
+
+	if(!g_velocity) return;
+
+	// Never bank more than one poll's worth of whole steps, so time spent
+	// with the buffer empty doesn't turn into a burst later. The Accumulator
+	// is full after 2 polls at a step or more per Report, or 65537 at the
+	// slowest, so clamp the polls first and the multiply can't wrap
+	uint32_t cap   = g_velocity + (VELOCITY_ONE - 1);
+	uint32_t most  = (g_velocity >= VELOCITY_ONE) ? 2 : (VELOCITY_ONE + 1);
+	if(polls > most) polls = most;
+
+	uint32_t earned = (polls == 1) ? g_velocity : polls * g_velocity;
+	if(g_velocity_acc >= cap || earned >= cap - g_velocity_acc) g_velocity_acc = cap;
+	else g_velocity_acc += earned;
+}
+
+
+void pacing_scale(void)
+{
+	g_pace_period = g_poll_period;
+
+	// Unlimited speed, only the Report Cap applies
+	if(g_mode->speed == 0)
+	{
+		g_velocity     = 0;
+		g_profile_peak = 0;
+		g_report_cap   = g_mode->report_cap;
+		return;
+	}
+
+	// Velocity = speed * interval in Q16.16 units per Report. With the
+	// interval in us that is  speed * us * 65536 / 10^6,  split so nothing
+	// overflows 32 bits
+	uint32_t period_us = g_poll_period / DELAY_US_TIME;
+	uint32_t units     = (uint32_t)g_mode->speed * period_us;
+	uint32_t velocity  = (units / 15625) * 1024 + ((units % 15625) * 1024) / 15625;
+
+	// Never slower than one step every 65536 polls, never faster than a
+	// Report can carry
+	if(velocity == 0) velocity = 1;
+	if(velocity > (127UL << 16)) velocity = 127UL << 16;
+	g_velocity = velocity;
+
+	// Whole steps per Report needed to keep up with the Velocity
+	int8_t peak  = (int8_t)((velocity + (VELOCITY_ONE - 1)) >> 16);
+	g_report_cap = (g_mode->report_cap > peak) ? g_mode->report_cap : peak;
+
+	// The Acceleration Profile reaches the Velocity over the ramp time, and
+	// limits the whole Report so either axis can use all of it
+	g_profile_peak = 0;
+	if(g_mode->ramp_ms)
+	{
+		// The ramp in Q8 Reports, and rounded to whole Reports
+		g_profile_ramp = ((uint32_t)g_mode->ramp_ms * 256000) / period_us;
+		uint32_t levels = (g_profile_ramp + (1 << 7)) >> 8;
+		if(levels == 0) levels = 1;
+
+		// Ramping up and down over those levels covers 2 n^2 / (2n - 1)
+		// Reports of cruising in 2n Reports, so falls behind by the rest
+		g_profile_levels = levels;
+		g_profile_lag    = ((levels * (levels - 1)) << 9) / ((levels << 1) - 1);
+		g_profile_cruise = ((uint32_t)g_mode->speed * g_mode->ramp_ms) / 1000;
+
+		g_profile_peak  = velocity;
+		g_report_cap    = REPORT_STEP_LIMIT;
+
+		// The Profile keeps the time itself, and cruises a little faster
+		// than the Velocity to make up for the ramps
+		g_velocity      = 0;
+	}
+}
+
+
+position_t mouse_instr_delta(const mouse_instr_t instr)
+{
+	position_t delta = {0, 0};
+
+	// [x] is -1 L  +1 R
+	// [y] is -1 U  +1 D
 	switch(instr)
 	{
 		case MOUSE_INSTR_L:
-			buffer[1] |= 0xFF;
+			delta.x = -1;
 			break;
 		case MOUSE_INSTR_R:
-			buffer[1] |= 0x01;
+			delta.x =  1;
 			break;
 
 		case MOUSE_INSTR_U:
-			buffer[2] |= 0xFF;
+			delta.y = -1;
 			break;
 		case MOUSE_INSTR_D:
-			buffer[2] |= 0x01;
+			delta.y =  1;
 			break;
 	}
+
+	return delta;
+}
+
+
+int16_t mouse_instr_wheel(const mouse_instr_t instr)
+{
+	if(instr == MOUSE_INSTR_WU) return  1;
+	if(instr == MOUSE_INSTR_WD) return -1;
+	return 0;
+}
+
+
+uint8_t report_axis_fits(const int16_t acc, const int16_t step)
+{
+	// No movement on this axis always fits
+	if(step == 0) return 0x01;
+
+	// Reject steps that would reverse the axis direction
+	if(step > 0 && acc < 0) return 0x00;
+	if(step < 0 && acc > 0) return 0x00;
+
+	// Reject steps beyond the cap
+	return (int_abs(acc + step) <= (uint32_t)g_report_cap);
+}
+
+
+int16_t int_rand(const int16_t range)
+{
+	// NOTE: rand_range() is exactly uniform and division free.
+	// Generate (Maximum * 2 + 1) values, then subtract Maximum
+	return (int16_t)rand_range((range << 1) + 1) - range;
+}
+
+
+int16_t cursor_reflect(int32_t target, const int16_t bound)
+{
+	// Mirror anything past an edge back into the box
+	if(target >  bound) target =  (2 * bound) - target;
+	if(target < -bound) target = -(2 * bound) - target;
+
+	// Moves longer than the whole box could still land outside, clamp those
+	if(target >  bound) target =  bound;
+	if(target < -bound) target = -bound;
+
+	return (int16_t)target;
 }
 
 
-int16_t int_rand(void)
+position_t plan_endpoint(const int16_t range)
 {
-	int16_t rand_num;
+	// Random target around the Virtual Cursor, reflected into the box
+	position_t target = {
+		.x = cursor_reflect((int32_t)g_cursor.x + int_rand(range), CURSOR_BOUND_X),
+		.y = cursor_reflect((int32_t)g_cursor.y + int_rand(range), CURSOR_BOUND_Y)
+	};
+
+	// Movement needed to get there from the Virtual Cursor
+	position_t movement = {
+		.x = target.x - g_cursor.x,
+		.y = target.y - g_cursor.y
+	};
+
+	g_cursor = target;
+	return movement;
+}
 
-	// NOTE: Generate a random number, bitmask it to get it within range
-	// so the modulo operation isn't noticable slow.
-	// Modulo by (Maximum + 1), then subtract (Maximum / 2)
 
-	// Generate different Ranges based on user setup
-	switch(g_user_mode)
+void cover_setup(void)
+{
+	// Tiles the size of the range, the last ones clipped by the box edge
+	int16_t tile = (g_mode->range > 0) ? g_mode->range : 1;
+	g_cover.tile    = tile;
+	g_cover.cols    = (2 * CURSOR_BOUND_X + tile) / tile;
+	g_cover.rows    = (2 * CURSOR_BOUND_Y + tile) / tile;
+
+	// One before the first tile, so the first call steps onto it
+	g_cover.col     = -1;
+	g_cover.row     = 0;
+	g_cover.col_dir = 1;
+	g_cover.row_dir = 1;
+	g_cover.target  = g_cursor;
+
+	halton_init(&g_cover.seq);
+	g_cover.offset  = (position_t){0, 0};
+}
+
+
+position_t plan_cover(void)
+{
+	// Reached the endpoint, move on to the next tile
+	if(g_cursor.x == g_cover.target.x && g_cursor.y == g_cover.target.y)
 	{
-		// +- 125 Units
-		case USER_MODE_NORMAL:
-			rand_num = rand() & 0x01FF; 
-			rand_num = (rand_num % 251) - 125;
-			break;
-		
+		g_cover.col += g_cover.col_dir;
 
-		// +- 250 Units
-		case USER_MODE_HI_RES:
-			rand_num = rand() & 0x03FF;
-			rand_num = (rand_num % 501) - 250;
-			break;
+		// End of a row, turn around on the next one
+		if(g_cover.col < 0 || g_cover.col >= g_cover.cols)
+		{
+			g_cover.col_dir = -g_cover.col_dir;
+			g_cover.col    += g_cover.col_dir;
+			g_cover.row    += g_cover.row_dir;
 
+			// Last row of a sweep, head back the other way from a new point
+			if(g_cover.row < 0 || g_cover.row >= g_cover.rows)
+			{
+				g_cover.row_dir = -g_cover.row_dir;
+				g_cover.row    += g_cover.row_dir;
 
-		// +- 20 Units
-		case USER_MODE_JITTER:
-			rand_num = rand() & 0x007F; 
-			rand_num = (rand_num % 41) - 20;
-			break;
+				uint16_t hx, hy;
+				halton_next(&g_cover.seq, &hx, &hy);
+				g_cover.offset.x = (int16_t)(((uint32_t)hx * g_cover.tile) >> 16);
+				g_cover.offset.y = (int16_t)(((uint32_t)hy * g_cover.tile) >> 16);
+			}
+		}
 
+		int32_t x = (int32_t)g_cover.col * g_cover.tile + g_cover.offset.x - CURSOR_BOUND_X;
+		int32_t y = (int32_t)g_cover.row * g_cover.tile + g_cover.offset.y - CURSOR_BOUND_Y;
+		g_cover.target.x = (int16_t)((x > CURSOR_BOUND_X) ? CURSOR_BOUND_X : x);
+		g_cover.target.y = (int16_t)((y > CURSOR_BOUND_Y) ? CURSOR_BOUND_Y : y);
+	}
 
-		// +- 2 Unit
-		case USER_MODE_STEPPED:
-			rand_num = rand() & 0x000F;
-			rand_num = (rand_num % 5) - 2;
-			break;
+	// Head towards it, no further than the range on each axis
+	int16_t range = g_cover.tile;
+	position_t movement = {
+		.x = g_cover.target.x - g_cursor.x,
+		.y = g_cover.target.y - g_cursor.y
+	};
+	if(movement.x >  range) movement.x =  range;
+	if(movement.x < -range) movement.x = -range;
+	if(movement.y >  range) movement.y =  range;
+	if(movement.y < -range) movement.y = -range;
+
+	g_cursor.x += movement.x;
+	g_cursor.y += movement.y;
+	return movement;
+}
 
 
-		default:
-			rand_num = 0x00;
-			break;
+void plan_pattern(const uint8_t playback)
+{
+	int16_t run_x, run_y;
+
+	// Queue the next straight run of the pattern
+	if(pattern_run(&g_pattern, PATTERN_RUN_MAX, &run_x, &run_y))
+	{
+		g_cursor.x += run_x;
+		g_cursor.y += run_y;
+		move_to_endpoint((position_t){run_x, run_y});
+		return;
+	}
+
+	// Recording finished, play the next one
+	if(playback)
+	{
+		pattern_playback(&g_pattern, recordings[g_pattern_next]);
+		if(++g_pattern_next >= RECORDING_COUNT) g_pattern_next = 0;
+	}
+
+	// Pattern finished, pick a random size for the next one that fits in
+	// the Virtual Cursor Box
+	else
+	{
+		int16_t rx = PATTERN_MIN_RADIUS + rand_range(CURSOR_BOUND_X - PATTERN_MIN_RADIUS + 1);
+		int16_t ry = PATTERN_MIN_RADIUS + rand_range(CURSOR_BOUND_Y - PATTERN_MIN_RADIUS + 1);
+
+		switch(g_pattern_next)
+		{
+			case 0:
+				pattern_ellipse(&g_pattern, ry, ry);              // Circle
+				break;
+			case 1:
+				pattern_ellipse(&g_pattern, rx, ry);
+				break;
+			case 2:
+				pattern_spiral(&g_pattern, 16 + rand_range(16), ry);
+				break;
+			case 3:
+				pattern_lissajous(&g_pattern, rx, ry, 1, 2);      // Figure-Eight
+				break;
+			case 4:
+				pattern_lissajous(&g_pattern, rx, ry, 3, 2);
+				break;
+		}
+		if(++g_pattern_next == PATTERN_COUNT) g_pattern_next = 0;
+	}
+
+	// Move from the Virtual Cursor to the start of the pattern
+	position_t movement = {
+		.x = g_pattern.x - g_cursor.x,
+		.y = g_pattern.y - g_cursor.y
+	};
+	g_cursor.x = g_pattern.x;
+	g_cursor.y = g_pattern.y;
+
+	move_to_endpoint(movement);
+}
+
+
+void plan_keep_awake(const int16_t nudge, const uint8_t wheel)
+{
+	// Whole seconds off the SysTick. The main loop comes round far more
+	// often than the counter wraps, so the subtraction never misses one
+	while((uint32_t)(SysTick->CNT - g_awake_tick) >= Ticks_from_Ms(1000))
+	{
+		g_awake_tick += Ticks_from_Ms(1000);
+		g_awake_secs++;
 	}
+	if(g_awake_secs < KEEP_AWAKE_PERIOD_S) return;
+	g_awake_secs = 0;
 
-    return rand_num;
+	// Out and back, so the cursor, or the page under it, ends where it
+	// started, and so does the Virtual Cursor
+	if(wheel)
+	{
+		move_wheel(nudge);
+		move_wheel(-nudge);
+		return;
+	}
+
+	// A new direction each time. The way back is the same vector turned
+	// half way round, which the sine table mirrors exactly
+	int16_t angle = (int16_t)rand_range(360);
+	move_by_vector((euclid_vector_t){angle,       (uint16_t)nudge});
+	move_by_vector((euclid_vector_t){angle + 180, (uint16_t)nudge});
 }
 
 
@@ -348,15 +1253,60 @@ uint32_t int_abs(const int32_t x)
 }
 
 
-mi_buffer_status_t mi_buffer_push(const mouse_instr_t instr)
+mouse_instr_t line_seg_step(line_seg_t *seg)
+{
+	mouse_instr_t instr = 0x00;
+
+	// A diagonal step holds back its Y Instruction, send that first
+	if(seg->pending)
+	{
+		instr = seg->pending;
+		seg->pending = 0x00;
+		seg->steps--;
+		return instr;
+	}
+
+	// Multiply the error by 2 to avoid fractional calculations
+	int32_t err2 = (int32_t)seg->err * 2;
+
+	// Step in the X direction - remove vertical error to account for
+	// the change in horizontal position
+	if(err2 > -seg->y_delta)
+	{
+		seg->err -= seg->y_delta;
+		instr = seg->x_instr;
+	}
+
+	// Step in the Y direction - add the horizontal error to account for
+	// the change in vertical position. If X also stepped, hold it back
+	if(err2 < seg->x_delta)
+	{
+		seg->err += seg->x_delta;
+
+		if(instr) seg->pending = seg->y_instr;
+		else      instr        = seg->y_instr;
+	}
+
+	seg->steps--;
+	return instr;
+}
+
+
+uint32_t mi_buffer_count(void)
+{
+	return (g_mi_buffer_head - g_mi_buffer_tail) & (MI_BUFFER_SIZE - 1);
+}
+
+
+mi_buffer_status_t mi_buffer_push(const line_seg_t *seg)
 {
 	// Calculate the next head position
-	uint32_t next_head = (g_mi_buffer_head + 1) % MI_BUFFER_SIZE;
+	uint32_t next_head = (g_mi_buffer_head + 1) & (MI_BUFFER_SIZE - 1);
 	// If there is no space left in the buffer, reject incomming data
 	if(next_head == g_mi_buffer_tail) return MI_BUFFER_NO_SPACE;
 
 	// Append the data to the current head position
-	g_mi_buffer[g_mi_buffer_head] = instr;
+	g_mi_buffer[g_mi_buffer_head] = *seg;
 	// Update the current head position
 	g_mi_buffer_head = next_head;
 
@@ -368,11 +1318,17 @@ mi_buffer_status_t mi_buffer_pop(mouse_instr_t *instr)
 {
 	// Exit if there is no more data to be popped off
 	if(g_mi_buffer_head == g_mi_buffer_tail) return MI_BUFFER_NO_DATA;
-	// Set the data pointer from the buffer
-	*instr = g_mi_buffer[g_mi_buffer_tail];
+	// Expand the next step from the current Line Segment
+	line_seg_t *seg = &g_mi_buffer[g_mi_buffer_tail];
+	*instr = line_seg_step(seg);
 
-	// Update the Tail Position
-	g_mi_buffer_tail = (g_mi_buffer_tail + 1) % MI_BUFFER_SIZE;
+	// Once the Line Segment is finished, update the Tail Position, and start
+	// the next one from rest
+	if(seg->steps == 0)
+	{
+		g_mi_buffer_tail = (g_mi_buffer_tail + 1) & (MI_BUFFER_SIZE - 1);
+		g_profile = (profile_t){0};
+	}
 
 	return MI_BUFFER_OK;
 }
@@ -382,8 +1338,9 @@ mi_buffer_status_t mi_buffer_peek(mouse_instr_t *instr)
 {
 	// Exit if there is no more data to be popped off
 	if(g_mi_buffer_head == g_mi_buffer_tail) return MI_BUFFER_NO_DATA;
-	// Set the data pointer from the buffer
-	*instr = g_mi_buffer[g_mi_buffer_tail];
+	// Expand the next step from a copy of the Line Segment, leaving it intact
+	line_seg_t seg = g_mi_buffer[g_mi_buffer_tail];
+	*instr = line_seg_step(&seg);
 
 	return MI_BUFFER_OK;
 }
@@ -391,61 +1348,66 @@ mi_buffer_status_t mi_buffer_peek(mouse_instr_t *instr)
 
 mi_buffer_status_t mi_buffer_skip(void)
 {
-	// Update the Tail Position
-	g_mi_buffer_tail = (g_mi_buffer_tail + 1) % MI_BUFFER_SIZE;
-	return MI_BUFFER_OK;
+	mouse_instr_t instr;
+	return mi_buffer_pop(&instr);
 }
 
 
 mi_buffer_status_t move_to_endpoint(const position_t endpoint)
 {
-	mi_buffer_status_t mi_return = MI_BUFFER_OK;
- 
 	position_t startpoint = {0, 0};
 
 	// Bresenham variables
 	// Delta x and y - total distances to cover in x and y direction
-	int32_t x_delta = int_abs(endpoint.x - startpoint.x);
-	int32_t y_delta = int_abs(endpoint.y - startpoint.y);
+	line_seg_t seg;
+	seg.x_delta = int_abs(endpoint.x - startpoint.x);
+	seg.y_delta = int_abs(endpoint.y - startpoint.y);
 	// Which direction to step in
-	int32_t x_step = (startpoint.x < endpoint.x)  ?  1 : -1;
-	int32_t y_step = (startpoint.y < endpoint.y)  ?  1 : -1;
+	seg.x_instr = (startpoint.x < endpoint.x)  ?  MOUSE_INSTR_R : MOUSE_INSTR_L;
+	seg.y_instr = (startpoint.y < endpoint.y)  ?  MOUSE_INSTR_U : MOUSE_INSTR_D;
 	// Accumulated Error - how far from the ideal line we are
-	int32_t err = x_delta - y_delta;
+	seg.err     = seg.x_delta - seg.y_delta;
+	// Every step in X and Y is one instruction
+	seg.steps   = seg.x_delta + seg.y_delta;
+	seg.pending = 0x00;
 
+	// Nothing to move, don't fill the buffer with an empty line
+	if(seg.steps == 0) return MI_BUFFER_OK;
 
-	// Step through the line until the destination is reached
-	while(startpoint.x != endpoint.x || startpoint.y != endpoint.y) 
-	{
-		// Multiply the error by 2 to avoid fractional calculations
-		int32_t err2 = err * 2;
+	return mi_buffer_push(&seg);
+}
 
-		// Step in the X direction - remove vertical error to account for
-		// the change in horizontal position
-		if(err2 > -y_delta)
-		{
-			err -= y_delta;
-			startpoint.x += x_step;
 
-			// Push Left or Right instructions to the Mouse Delta Buffer
-			mi_return = mi_buffer_push( (x_step > 0) ? MOUSE_INSTR_R : MOUSE_INSTR_L);
-			// If the buffer is full, exit early
-			if(mi_return != MI_BUFFER_OK)  return mi_return;
-		}
+mi_buffer_status_t move_wheel(const int16_t ticks)
+{
+	// A line along X only, so every step is the wheel instruction
+	line_seg_t seg = {0};
+	seg.x_delta = int_abs(ticks);
+	seg.x_instr = (ticks > 0) ? MOUSE_INSTR_WU : MOUSE_INSTR_WD;
+	seg.err     = seg.x_delta;
+	seg.steps   = seg.x_delta;
 
-		// Step in the Y direction - add the horizontal error to account for
-		// the change in vertical position
-		if(err2 < x_delta) 
-		{
-			err += x_delta;
-			startpoint.y += y_step;
+	if(seg.steps == 0) return MI_BUFFER_OK;
 
-			// Push Up and Down Instructions to the Mouse Delta Buffer
-			mi_return = mi_buffer_push( (y_step > 0) ? MOUSE_INSTR_U : MOUSE_INSTR_D);
-			// If the buffer is full, exit early
-			if(mi_return != MI_BUFFER_OK)  return mi_return;
-		}
-	}
+	return mi_buffer_push(&seg);
+}
 
-	return mi_return;
+
+mi_buffer_status_t move_by_vector(const euclid_vector_t vect)
+{
+	int32_t sin_q15, cos_q15;
+	mini_sincos(vect.angle, &sin_q15, &cos_q15);
+
+	// Calculate X and Y end point from distance and angle
+	position_t endpoint = {
+		.x = mini_scale_q15(vect.distance, cos_q15),
+		.y = mini_scale_q15(vect.distance, sin_q15)
+	};
+
+	mi_buffer_status_t status = move_to_endpoint(endpoint);
+	if(status != MI_BUFFER_OK) return status;
+
+	g_cursor.x += endpoint.x;
+	g_cursor.y += endpoint.y;
+	return MI_BUFFER_OK;
 }
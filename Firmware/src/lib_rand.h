@@ -1,5 +1,6 @@
 /******************************************************************************
-* Psuedo Random Number Generator using a Linear Feedback Shift Register
+* Psuedo Random Number Generator using a Linear Feedback Shift Register, and
+* word-at-a-time Xorshift generators for the higher strengths
 * See the GitHub for more information:
 * https://github.com/ADBeta/CH32V003_lib_rand
 *
@@ -30,8 +31,8 @@
 
 // Define the strength of the random generation. Do this in funconfig.h
 // Strength 1: Tap and shift the LFSR, then returns the LFSR value as is
-// Strength 2: Generate 32 random bits using the LFSR
-// Strength 3: Genetate two 32bit values using the LFSR, then XOR them together
+// Strength 2: Xorshift32 (13, 17, 5) - 32 new bits per call, period 2^32 - 1
+// Strength 3: Two word Xorshift (10, 13, 10) - period 2^64 - 1
 // Example:    #define RANDOM_STRENGTH 2
 
 #ifndef RANDOM_STRENGTH 
@@ -41,6 +42,10 @@
 // @brief set the random LFSR values seed by default to a known-good value
 static uint32_t _rand_lfsr = 0x747AA32F;
 
+// @brief Second state word for Strength 3. Never seeded, so the combined
+// state can never be all zeros
+static uint32_t _rand_lfsr_b = 0x159A55E5;
+
 
 /*** Library specific Functions - Do Not Use *********************************/
 /****************************************************************************/
@@ -66,30 +71,43 @@ uint8_t _rand_lfsr_update(void)
 }
 
 
-/// @brief Generates a Random 32-bit number, using the LFSR - by generating
-/// a random bit from LFSR taps, 32 times.
+/// @brief Generates a Random 32-bit number, using Xorshift32 - all 32 bits
+/// are updated in a handful of shift/XOR instructions, rather than one LFSR
+/// bit per loop.
 /// @param None
 /// @return a (psuedo)random 32-bit value
 uint32_t _rand_gen_32b(void)
 {
-	uint32_t rand_out = 0;
-	
-	uint8_t bits = 32;
-	while(bits--)
-	{
-		// Shift the current rand value for the new LSB
-		rand_out = rand_out << 1;
-		// Append the LSB
-		rand_out |= _rand_lfsr_update();
-	}
-	
-	return rand_out;
+	// Shift and XOR the whole word - Linear like the LFSR, but every bit
+	// of the state is updated at once
+	uint32_t x = _rand_lfsr;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+
+	_rand_lfsr = x;
+	return x;
+}
+
+
+/// @brief Generates a Random 32-bit number, using a two word Xorshift.
+/// The second word is mixed into the first, so the period is 2^64 - 1
+/// @param None
+/// @return a (psuedo)random 32-bit value
+uint32_t _rand_gen_64b(void)
+{
+	uint32_t t = _rand_lfsr ^ (_rand_lfsr << 10);
+	_rand_lfsr   = _rand_lfsr_b;
+	_rand_lfsr_b = (_rand_lfsr_b ^ (_rand_lfsr_b >> 10)) ^ (t ^ (t >> 13));
+
+	return _rand_lfsr_b;
 }
 
 
 /*** API Functions ***********************************************************/
 /*****************************************************************************/
-/// @brief seeds the Random LFSR to the value passed
+/// @brief seeds the Random LFSR to the value passed. Must not be 0 for
+/// Strength 1 and 2
 /// @param uint32_t seed
 /// @return None
 void seed(const uint32_t seed_val)
@@ -113,21 +131,45 @@ uint32_t rand(void)
 	rand_out = _rand_lfsr;
 	#endif
 
-	// If RANDOM_STRENGTH is level 2, generate a 32-bit output, using 32 random
-	// bits from the LFSR
+	// If RANDOM_STRENGTH is level 2, generate a 32-bit output, using a single
+	// Xorshift32 step
 	#if RANDOM_STRENGTH == 2
 	rand_out = _rand_gen_32b();
 	#endif
 
-	// If RANDOM_STRENGTH is level 3, generate 2 32-bit outputs, then XOR them
-	// together
+	// If RANDOM_STRENGTH is level 3, generate a 32-bit output from the two
+	// word Xorshift
 	#if RANDOM_STRENGTH == 3
-	uint32_t rand_a = _rand_gen_32b();
-	uint32_t rand_b = _rand_gen_32b();
-	rand_out = rand_a ^ rand_b;
+	rand_out = _rand_gen_64b();
 	#endif
 
 	return rand_out;
 }
 
+
+/// @brief Generates an unbiased random number from 0 to (range - 1).
+/// Uses power-of-two rejection sampling: the random value is masked to the
+/// smallest power of two that covers the range, and retried if it lands
+/// outside it. Only shifts and masks are used, no division
+/// @param uint32_t range, number of possible values. Must not be 0
+/// @return Random value within range
+uint32_t rand_range(const uint32_t range)
+{
+	// Smear the highest set bit of (range - 1) down to make the mask
+	uint32_t mask = range - 1;
+	mask |= mask >> 1;
+	mask |= mask >> 2;
+	mask |= mask >> 4;
+	mask |= mask >> 8;
+	mask |= mask >> 16;
+
+	// Retry until the value lands in range. Always under 50% chance to retry
+	uint32_t rand_out;
+	do {
+		rand_out = rand() & mask;
+	} while(rand_out >= range);
+
+	return rand_out;
+}
+
 #endif
@@ -0,0 +1,103 @@
+/******************************************************************************
+* Bare minimim math.h implimentations for the current project (insomniac)
+* Integer only - sin() and cos() come from a quarter-wave table in Q15,
+* generated at build time into $(BUILD_DIR)/sine_table.h, so no libgcc
+* soft-float is needed. The table is 182 Bytes of flash. sqrt() is found a
+* bit at a time, with shifts and subtracts only.
+*
+* ADBeta (c) 2025-2026
+******************************************************************************/
+#ifndef INSOMNIAC_MINI_MATH_H
+#define INSOMNIAC_MINI_MATH_H
+
+#include "sine_table.h"
+
+// Q15 fixed point - 1.0 is 32768
+#define MINI_Q15_ONE      32768
+
+
+/*** Library specific Functions - Do Not Use *********************************/
+/*****************************************************************************/
+/// @brief Wraps an angle in degrees into 0 - 359
+/// @param Angle in degrees, any value
+/// @return Angle in degrees, 0 - 359
+int16_t _mini_wrap_degrees(int16_t angle)
+{
+	while(angle >= 360) angle -= 360;
+	while(angle <    0) angle += 360;
+	return angle;
+}
+
+
+
+/*** API Functions ***********************************************************/
+/*****************************************************************************/
+/// @brief Sine and Cosine of a whole degree angle, from the quarter-wave
+/// table. Angles go anticlockwise from the +X axis
+/// @param Angle in degrees, any value
+/// @param sin(angle) in Q15
+/// @param cos(angle) in Q15
+/// @return None
+void mini_sincos(int16_t angle, int32_t *sin_q15, int32_t *cos_q15)
+{
+	angle = _mini_wrap_degrees(angle);
+
+	// Fold each quadrant back onto 0 - 90 degrees
+	if(angle < 90)
+	{
+		*sin_q15 =  sine_table[angle];
+		*cos_q15 =  sine_table[90 - angle];
+	} else if(angle < 180) {
+		*sin_q15 =  sine_table[180 - angle];
+		*cos_q15 = -sine_table[angle - 90];
+	} else if(angle < 270) {
+		*sin_q15 = -sine_table[angle - 180];
+		*cos_q15 = -sine_table[270 - angle];
+	} else {
+		*sin_q15 = -sine_table[360 - angle];
+		*cos_q15 =  sine_table[angle - 270];
+	}
+}
+
+
+/// @brief Multiplies a distance by a Q15 value, rounding to the nearest unit
+/// @param Distance, 0 - 32767
+/// @param Q15 value, -32768 - 32768
+/// @return distance * q15, rounded
+int16_t mini_scale_q15(const uint16_t distance, const int32_t q15)
+{
+	// Round the magnitude, so +ve and -ve results mirror each other
+	uint32_t mag = (q15 < 0) ? -q15 : q15;
+	int16_t  out = (int16_t)(((uint32_t)distance * mag + (MINI_Q15_ONE / 2)) >> 15);
+
+	return (q15 < 0) ? -out : out;
+}
+
+
+/// @brief Square root of an unsigned integer, rounded down
+/// @param Value, any
+/// @return floor(sqrt(value))
+uint32_t mini_sqrt(uint32_t value)
+{
+	uint32_t root = 0;
+	uint32_t bit  = 1UL << 30;
+
+	// Start from the highest power of 4 in the value, then try each bit of
+	// the root from the top down, keeping it if the square still fits
+	while(bit > value) bit >>= 2;
+	while(bit)
+	{
+		if(value >= root + bit)
+		{
+			value -= root + bit;
+			root   = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+#endif
@@ -0,0 +1,438 @@
+/******************************************************************************
+* Integer Pattern Generators for the Insomniac Motion Engine
+* Rasterizes curves into 8-connected unit steps, one step per call, so they
+* can be streamed into the Mouse Instruction Buffer as it drains.
+* Once a pattern has started, each step costs only adds, subtracts, shifts
+* and compares - no float, and no libgcc multiply or divide.
+*
+* Every pattern is traced around a centre point at (0, 0), anticlockwise
+* (X right, Y up), and all its state lives in a pattern_t, so a pattern can
+* be paused and resumed at any step.
+*
+*   Circle / Ellipse   Midpoint tracer of  ry^2 x^2 + rx^2 y^2 - rx^2 ry^2 = 0
+*   Spiral             Circle tracer whose r^2 grows by pitch/pi per unit
+*                      of path, which gives an Archimedean spiral
+*   Lissajous          Two Minsky shift-oscillators, x = A cos(fx t) and
+*                      y = B sin(fy t). Figure-Eight is Lissajous at 1:2
+*   Playback           Recorded path, decoded from flash a few bits per step
+*
+* Recordings are a chain code - each step is the turn from the direction of
+* the last one, canonical Huffman coded. Straight and gently curving paths
+* cost 1 - 2 bits per step. Layout, made by host/path_encode.c:
+*   [0 - 7]    Number of codes of each length, 1 - 8 bits
+*   [8 - 16]   Symbols in canonical order. 0 - 7 turns, 8 is the end
+*   [17 - 20]  Start X, Start Y from the centre, int16_t little endian
+*   [21]       Direction before the first step
+*   [22 - ]    Codes, MSB first
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#ifndef INSOMNIAC_PATTERNS_H
+#define INSOMNIAC_PATTERNS_H
+
+// Lissajous oscillators turn by 2^-SHIFT radians per tick. 10 keeps a 400
+// unit, 3x frequency pattern to about one unit per tick
+#define PATTERN_OSC_SHIFT      10
+#define PATTERN_OSC_ROUND      (1 << (PATTERN_OSC_SHIFT - 1))
+
+// Largest Ellipse radius. The tracer's F and gradient terms reach about
+// 2.9 r^3, which overflows an int32_t past r = 900
+#define PATTERN_MAX_RADIUS     800
+
+// Recorded path layout
+#define PLAYBACK_MAX_BITS      8
+#define PLAYBACK_SYMBOLS       9
+#define PLAYBACK_END           8
+#define PLAYBACK_COUNTS        0
+#define PLAYBACK_ORDER         (PLAYBACK_COUNTS + PLAYBACK_MAX_BITS)
+#define PLAYBACK_START         (PLAYBACK_ORDER + PLAYBACK_SYMBOLS)
+#define PLAYBACK_DIR           (PLAYBACK_START + 4)
+#define PLAYBACK_CODES         (PLAYBACK_DIR + 1)
+
+
+/// @brief Pattern Generator types
+typedef enum {
+	PATTERN_CONIC        = 0,       // Circle, Ellipse and Spiral
+	PATTERN_LISSAJOUS,              // Lissajous and Figure-Eight
+	PATTERN_PLAYBACK                // Recorded path
+} pattern_kind_t;
+
+
+/// @brief A single unit step, -1, 0 or 1 on each axis
+typedef struct {
+	int8_t           x;
+	int8_t           y;
+} pattern_step_t;
+
+
+/// @brief Pattern Generator state. Fill with one of the pattern_ functions
+/// then take steps with pattern_step() or pattern_run()
+typedef struct {
+	pattern_kind_t   kind;
+	int16_t          x;             // Current position from the centre
+	int16_t          y;
+	int32_t          left;          // Steps, r^2 growth or ticks left to go
+
+	union {
+		// Implicit curve tracer. F is 0 on the curve, the gradient terms
+		// are 2 * k * position, so moving 1 unit changes F by (+-g + k)
+		struct {
+			int32_t  f;             // Value of F at (x, y)
+			int32_t  gx;            // X Gradient term
+			int32_t  gy;            // Y Gradient term
+			int32_t  kx;            // X Weight
+			int32_t  ky;            // Y Weight
+			int32_t  grow;          // Spiral r^2 growth for an axial step
+			int32_t  grow_diag;     // Spiral r^2 growth for a diagonal step
+		} conic;
+
+		// Minsky oscillators, Q8 amplitudes
+		struct {
+			int32_t  xc;            // X Oscillator, A cos(fx t)
+			int32_t  xs;
+			int32_t  yc;            // Y Oscillator, B sin(fy t)
+			int32_t  ys;
+			uint8_t  fx;            // Oscillator steps per tick
+			uint8_t  fy;
+		} osc;
+
+		// Recorded path decoder, reads straight from flash
+		struct {
+			const uint8_t *data;    // Recording
+			uint32_t bit;           // Next bit of the codes to read
+			uint8_t  dir;           // Direction of the last step
+		} rec;
+	};
+} pattern_t;
+
+
+
+/*** Library specific Functions - Do Not Use *********************************/
+/*****************************************************************************/
+// @brief Unit step for each chain code direction, anticlockwise from +X
+static const int8_t _pattern_dir_x[8] = { 1,  1,  0, -1, -1, -1,  0,  1};
+static const int8_t _pattern_dir_y[8] = { 0,  1,  1,  1,  0, -1, -1, -1};
+
+
+/// @brief Branch free abs() of an int32_t
+/// @param x
+/// @return abs(x)
+int32_t _pattern_abs(const int32_t x)
+{
+	int32_t mask = x >> 31;
+	return (x ^ mask) - mask;
+}
+
+
+/// @brief Takes one step along an implicit curve. Travels anticlockwise,
+/// the direction on each axis comes from the quadrant. The axis the curve
+/// is moving along fastest always steps, the other only steps if that lands
+/// closer to the curve
+/// @param Pattern pointer
+/// @param Step to populate
+/// @return 0x01 if a step was taken, 0x00 if the pattern is finished
+uint8_t _pattern_conic_step(pattern_t *pat, pattern_step_t *step)
+{
+	if(pat->left <= 0) return 0x00;
+
+	// Anticlockwise direction from the quadrant, the half-open axes keep
+	// every point in exactly one quadrant
+	int8_t sx = (pat->y > 0 || (pat->y == 0 && pat->x > 0))  ?  -1 : 1;
+	int8_t sy = (pat->x > 0 || (pat->x == 0 && pat->y < 0))  ?   1 : -1;
+
+	// Change in F for a step on each axis
+	int32_t dfx = ((sx > 0) ? pat->conic.gx : -pat->conic.gx) + pat->conic.kx;
+	int32_t dfy = ((sy > 0) ? pat->conic.gy : -pat->conic.gy) + pat->conic.ky;
+
+	// The tangent is along the gradient rotated 90 degrees, so X is the
+	// major axis when the Y gradient is steeper
+	uint8_t x_major = _pattern_abs(pat->conic.gy) > _pattern_abs(pat->conic.gx);
+
+	int32_t f_axial = pat->conic.f + (x_major ? dfx : dfy) - pat->conic.grow;
+	int32_t f_diag  = pat->conic.f + dfx + dfy - pat->conic.grow_diag;
+
+	step->x = sx;
+	step->y = sy;
+	if(_pattern_abs(f_axial) <= _pattern_abs(f_diag))
+	{
+		if(x_major) step->y = 0;
+		else        step->x = 0;
+
+		pat->conic.f = f_axial;
+		pat->left   -= (pat->conic.grow) ? pat->conic.grow : 1;
+	} else {
+		pat->conic.f = f_diag;
+		pat->left   -= (pat->conic.grow_diag) ? pat->conic.grow_diag : 1;
+	}
+
+	// Move, and keep the gradient terms in step with the position
+	if(step->x)
+	{
+		pat->x          += sx;
+		pat->conic.gx   += (sx > 0) ? (pat->conic.kx << 1) : -(pat->conic.kx << 1);
+	}
+	if(step->y)
+	{
+		pat->y          += sy;
+		pat->conic.gy   += (sy > 0) ? (pat->conic.ky << 1) : -(pat->conic.ky << 1);
+	}
+
+	// An Ellipse only crosses the positive X axis where it started
+	if(!pat->conic.grow && pat->y == 0 && pat->x > 0) pat->left = 0;
+
+	return 0x01;
+}
+
+
+/// @brief Takes one step towards the current Lissajous point, ticking the
+/// oscillators along whenever the point has been reached
+/// @param Pattern pointer
+/// @param Step to populate
+/// @return 0x01 if a step was taken, 0x00 if the pattern is finished
+uint8_t _pattern_lissajous_step(pattern_t *pat, pattern_step_t *step)
+{
+	int16_t tx, ty;
+
+	while(1)
+	{
+		// Round the Q8 oscillator outputs to the nearest unit
+		tx = (pat->osc.xc + 128) >> 8;
+		ty = (pat->osc.ys + 128) >> 8;
+		if(tx != pat->x || ty != pat->y) break;
+
+		if(pat->left <= 0) return 0x00;
+		pat->left--;
+
+		// Minsky rotation, x -= y * e, y += x * e. Using the new x keeps
+		// the orbit closed. The shifts round to nearest, flooring would
+		// bias every step the same way and warp the orbit by a few units
+		for(uint8_t n = 0; n < pat->osc.fx; n++)
+		{
+			pat->osc.xc -= (pat->osc.xs + PATTERN_OSC_ROUND) >> PATTERN_OSC_SHIFT;
+			pat->osc.xs += (pat->osc.xc + PATTERN_OSC_ROUND) >> PATTERN_OSC_SHIFT;
+		}
+		for(uint8_t n = 0; n < pat->osc.fy; n++)
+		{
+			pat->osc.yc -= (pat->osc.ys + PATTERN_OSC_ROUND) >> PATTERN_OSC_SHIFT;
+			pat->osc.ys += (pat->osc.yc + PATTERN_OSC_ROUND) >> PATTERN_OSC_SHIFT;
+		}
+	}
+
+	step->x = (tx > pat->x) - (tx < pat->x);
+	step->y = (ty > pat->y) - (ty < pat->y);
+	pat->x += step->x;
+	pat->y += step->y;
+
+	return 0x01;
+}
+
+
+
+/// @brief Decodes the next canonical Huffman symbol of a recording. Codes
+/// of each length are consecutive numbers, so one compare per bit finds it
+/// @param Pattern pointer
+/// @return Symbol, 0 - 7 turn or PLAYBACK_END
+uint8_t _pattern_playback_symbol(pattern_t *pat)
+{
+	const uint8_t *rec = pat->rec.data;
+	int16_t code = 0, first = 0, index = 0;
+
+	for(uint8_t len = 0; len < PLAYBACK_MAX_BITS; len++)
+	{
+		uint32_t bit = pat->rec.bit++;
+		code |= (rec[PLAYBACK_CODES + (bit >> 3)] >> (7 - (bit & 0x07))) & 0x01;
+
+		// Is it one of the codes of this length
+		int16_t count = rec[PLAYBACK_COUNTS + len];
+		if(code - first < count) return rec[PLAYBACK_ORDER + index + code - first];
+
+		index  += count;
+		first   = (first + count) << 1;
+		code  <<= 1;
+	}
+
+	// Not a valid code, end the recording rather than play garbage
+	return PLAYBACK_END;
+}
+
+
+/// @brief Takes the next step of a recording
+/// @param Pattern pointer
+/// @param Step to populate
+/// @return 0x01 if a step was taken, 0x00 if the recording is finished
+uint8_t _pattern_playback_step(pattern_t *pat, pattern_step_t *step)
+{
+	if(pat->left <= 0) return 0x00;
+
+	uint8_t turn = _pattern_playback_symbol(pat);
+	if(turn >= PLAYBACK_END)
+	{
+		pat->left = 0;
+		return 0x00;
+	}
+
+	pat->rec.dir = (pat->rec.dir + turn) & 0x07;
+	step->x = _pattern_dir_x[pat->rec.dir];
+	step->y = _pattern_dir_y[pat->rec.dir];
+	pat->x += step->x;
+	pat->y += step->y;
+
+	return 0x01;
+}
+
+
+
+/*** API Functions ***********************************************************/
+/*****************************************************************************/
+/// @brief Starts an Ellipse, or a Circle if both radii match. Starts and
+/// finishes at (rx, 0)
+/// @param Pattern pointer
+/// @param X Radius, 1 - PATTERN_MAX_RADIUS, larger is clamped
+/// @param Y Radius, 1 - PATTERN_MAX_RADIUS, larger is clamped
+/// @return None
+void pattern_ellipse(pattern_t *pat, int16_t rx, int16_t ry)
+{
+	if(rx > PATTERN_MAX_RADIUS) rx = PATTERN_MAX_RADIUS;
+	if(ry > PATTERN_MAX_RADIUS) ry = PATTERN_MAX_RADIUS;
+
+	pat->kind = PATTERN_CONIC;
+	pat->x    = rx;
+	pat->y    = 0;
+	// Every quadrant moves rx units in X and ry in Y, at most one each step
+	pat->left = 4 * ((int32_t)rx + ry);
+
+	// F = ry^2 x^2 + rx^2 y^2 - rx^2 ry^2, which is 0 at (rx, 0)
+	pat->conic.f         = 0;
+	pat->conic.kx        = (int32_t)ry * ry;
+	pat->conic.ky        = (int32_t)rx * rx;
+	pat->conic.gx        = 2 * pat->conic.kx * rx;
+	pat->conic.gy        = 0;
+	pat->conic.grow      = 0;
+	pat->conic.grow_diag = 0;
+}
+
+
+/// @brief Starts an Archimedean Spiral, from one turn out at (pitch, 0) to
+/// a maximum radius. Any closer in, the path moves outwards as much as it
+/// goes around, and r^2 would grow too fast
+/// @param Pattern pointer
+/// @param Distance between each turn, 1 - 255
+/// @param Maximum Radius, pitch - 1000
+/// @return None
+void pattern_spiral(pattern_t *pat, const uint8_t pitch, const int16_t r_max)
+{
+	pat->kind = PATTERN_CONIC;
+	pat->x    = pitch;
+	pat->y    = 0;
+
+	// F = 256 (x^2 + y^2) - r^2, all in Q8. r = pitch * turns means r^2
+	// grows by pitch / pi for every unit of path.
+	// A traced circle is 0.414 r axial and 0.293 r diagonal steps per
+	// octant, weighting a diagonal as 1.266 makes every turn 2 pi r long
+	pat->conic.kx        = 256;
+	pat->conic.ky        = 256;
+	pat->conic.gx        = 512 * (int32_t)pitch;
+	pat->conic.gy        = 0;
+	pat->conic.f         = 0;
+	pat->conic.grow      = ((int32_t)pitch * 163) >> 1;          // 256 / pi
+	pat->conic.grow_diag = (pat->conic.grow * 324) >> 8;         // * 1.266
+
+	pat->left = ((int32_t)r_max * r_max - (int32_t)pitch * pitch) * 256;
+}
+
+
+/// @brief Starts a Lissajous curve, x = ax cos(fx t) and y = ay sin(fy t),
+/// for one full turn of t. Starts at (ax, 0). 1:2 is a Figure-Eight
+/// @param Pattern pointer
+/// @param X Amplitude, 1 - 1000
+/// @param Y Amplitude, 1 - 1000
+/// @param X Frequency, 1 - 8
+/// @param Y Frequency, 1 - 8
+/// @return None
+void pattern_lissajous(pattern_t *pat, const int16_t ax, const int16_t ay,
+                                       const uint8_t fx, const uint8_t fy)
+{
+	pat->kind = PATTERN_LISSAJOUS;
+	pat->x    = ax;
+	pat->y    = 0;
+	// One turn of t is 2 pi * 2^SHIFT ticks
+	pat->left = ((int32_t)3217 << PATTERN_OSC_SHIFT) >> 9;
+
+	pat->osc.xc = (int32_t)ax << 8;
+	pat->osc.xs = 0;
+	pat->osc.yc = (int32_t)ay << 8;
+	pat->osc.ys = 0;
+	pat->osc.fx = fx;
+	pat->osc.fy = fy;
+}
+
+
+/// @brief Starts playing a recording made by host/path_encode.c. Starts at
+/// the recorded start point, which centres the drawing
+/// @param Pattern pointer
+/// @param Recording, must stay valid while playing
+/// @return None
+void pattern_playback(pattern_t *pat, const uint8_t *recording)
+{
+	pat->kind = PATTERN_PLAYBACK;
+	pat->x    = (int16_t)(recording[PLAYBACK_START]     | (recording[PLAYBACK_START + 1] << 8));
+	pat->y    = (int16_t)(recording[PLAYBACK_START + 2] | (recording[PLAYBACK_START + 3] << 8));
+	pat->left = 1;
+
+	pat->rec.data = recording;
+	pat->rec.bit  = 0;
+	pat->rec.dir  = recording[PLAYBACK_DIR] & 0x07;
+}
+
+
+/// @brief Takes the next step of a pattern
+/// @param Pattern pointer
+/// @param Step to populate
+/// @return 0x01 if a step was taken, 0x00 if the pattern is finished
+uint8_t pattern_step(pattern_t *pat, pattern_step_t *step)
+{
+	if(pat->kind == PATTERN_LISSAJOUS) return _pattern_lissajous_step(pat, step);
+	if(pat->kind == PATTERN_PLAYBACK)  return _pattern_playback_step(pat, step);
+	return _pattern_conic_step(pat, step);
+}
+
+
+/// @brief Takes a run of identical steps from a pattern, which together are
+/// a straight line. The step after the run is found by stepping a copy, so
+/// the pattern is left at the end of the run
+/// @param Pattern pointer
+/// @param Maximum steps in the run, 1 - 255
+/// @param X Movement of the run
+/// @param Y Movement of the run
+/// @return Number of steps in the run, 0 if the pattern is finished
+uint8_t pattern_run(pattern_t *pat, const uint8_t max_steps, int16_t *x, int16_t *y)
+{
+	pattern_step_t first, next;
+	pattern_t      peek;
+	uint8_t        steps = 0;
+
+	*x = 0;
+	*y = 0;
+	if(!pattern_step(pat, &first)) return 0;
+
+	*x    = first.x;
+	*y    = first.y;
+	steps = 1;
+
+	while(steps < max_steps)
+	{
+		// Look at the next step, only keep it if it continues the line
+		peek = *pat;
+		if(!pattern_step(&peek, &next)) break;
+		if(next.x != first.x || next.y != first.y) break;
+
+		*pat = peek;
+		*x  += next.x;
+		*y  += next.y;
+		steps++;
+	}
+
+	return steps;
+}
+
+#endif
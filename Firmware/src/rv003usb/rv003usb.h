@@ -61,7 +61,8 @@ struct usb_endpoint;
 struct rv003usb_internal;
 struct usb_urb;
 
-// usb_handle_interrupt_in is OBLIGATED to call usb_send_data or usb_send_empty.
+// usb_handle_interrupt_in is OBLIGATED to call usb_send_data, usb_send_empty
+// or usb_send_nak.
 // Enable with RV003USB_HANDLE_IN_REQUEST=1
 void usb_handle_user_in_request( struct usb_endpoint * e, uint8_t * scratchpad, int endp, uint32_t sendtok, struct rv003usb_internal * ist );
 
@@ -96,6 +97,10 @@ void usb_pid_handle_ack( uint32_t dummy, uint8_t * data, uint32_t dummy2, uint32
 void usb_send_data( const void * data, uint32_t length, uint32_t poly_function, uint32_t token );
 void usb_send_empty( uint32_t token );
 
+// Answers an IN token with a NAK, for when there is nothing new to send.
+// The data toggle is left alone, as the host won't ACK it.
+void usb_send_nak( void );
+
 void usb_setup();
 
 
@@ -16,6 +16,12 @@
 #define RV003USB_HANDLE_USER_DATA    0
 #define RV003USB_HID_FEATURES        0
 
+// Mouse endpoint poll interval, ms. Set in funconfig.h
+#include "funconfig.h"
+#ifndef USB_POLL_INTERVAL_MS
+	#define USB_POLL_INTERVAL_MS     10
+#endif
+
 
 #ifndef __ASSEMBLER__
 
@@ -129,7 +135,7 @@ static const uint8_t config_descriptor[] = {  //Mostly stolen from a USB mouse I
 	0x81,              // Endpoint Address
 	0x03,              // Attributes
 	0x04, 0x00,        // Size
-	10,                 // Interval (Number of milliseconds between polls)
+	USB_POLL_INTERVAL_MS, // Interval (Number of milliseconds between polls)
 };
 
 
@@ -0,0 +1,81 @@
+/******************************************************************************
+* Deferred-Format Binary Trace over the Debug Printf Ring
+* TRACE("x=%d y=%d\n", x, y) works like printf, but the firmware never
+* formats anything. The format string goes in the .trace_fmt section, which
+* the linker script keeps in the ELF as an INFO section at address 0, so it
+* is never loaded to flash and each string's address is its offset there,
+* the ID. The link fails if the strings outgrow the 16 bit IDs. A record is
+* only the ID and the raw argument words, put in the ring from debug_print.c
+* whole or not at all. host/trace_decode.c reads the strings back out of the
+* ELF and formats the records on the host.
+*
+* Record layout, little endian:
+*   [0]        TRACE_HEADER | argument count (0 - 4)
+*   [1 - 2]    Format ID, offset of the string in .trace_fmt
+*   [3 - ]     Arguments, 4 bytes each
+* The header byte never appears in UTF-8 text, so records and printf output
+* share the ring and the decoder passes the text straight through.
+*
+* Arguments are taken as 32 bit words, so %d %i %u %x %X %o and %c, with
+* any flags and width, format like printf. %s can't be traced.
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#ifndef INSOMNIAC_TRACE_H
+#define INSOMNIAC_TRACE_H
+
+#include <stdint.h>
+#include "debug_print.h"
+
+#define TRACE_HEADER         0xF8
+#define TRACE_MAX_ARGS       4
+#define TRACE_RECORD_MAX     (3 + 4 * TRACE_MAX_ARGS)
+
+// Placed by the .trace_fmt output section of toolkit/ch32v003fun.ld, and
+// host/trace_fmt.ld on the host
+#define TRACE_SECTION        ".trace_fmt"
+
+
+/// @brief Packs a record and puts it in the ring, or drops it if it won't fit
+/// @param Format ID
+/// @param Argument words
+/// @param Argument count, 0 - TRACE_MAX_ARGS
+/// @return None
+static inline void trace_write(const uint16_t id, const uint32_t *args, const uint8_t argc)
+{
+	uint8_t rec[TRACE_RECORD_MAX];
+
+	rec[0] = TRACE_HEADER | argc;
+	rec[1] = (uint8_t)id;
+	rec[2] = (uint8_t)(id >> 8);
+
+	uint8_t len = 3;
+	for(uint8_t a = 0; a < argc; a++)
+	{
+		rec[len++] = (uint8_t)args[a];
+		rec[len++] = (uint8_t)(args[a] >> 8);
+		rec[len++] = (uint8_t)(args[a] >> 16);
+		rec[len++] = (uint8_t)(args[a] >> 24);
+	}
+
+	debug_print_record(rec, len);
+}
+
+
+#if DEBUG_PRINT_RING
+/// @brief Traces a format string and up to TRACE_MAX_ARGS integer arguments
+#define TRACE(fmt, ...)                                                       \
+	do {                                                                      \
+		static const char _trace_fmt[]                                        \
+			__attribute__((section(TRACE_SECTION), used)) = fmt;              \
+		const uint32_t _trace_args[] = {0, ##__VA_ARGS__};                    \
+		_Static_assert(sizeof(_trace_args) <= 4 * (TRACE_MAX_ARGS + 1),       \
+		               "TRACE takes at most 4 arguments");                    \
+		trace_write((uint16_t)(uintptr_t)_trace_fmt, &_trace_args[1],         \
+		            sizeof(_trace_args) / 4 - 1);                             \
+	} while(0)
+#else
+#define TRACE(fmt, ...)      do {} while(0)
+#endif
+
+#endif
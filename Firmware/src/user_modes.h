@@ -0,0 +1,91 @@
+/******************************************************************************
+* User Mode Registry for the Insomniac Motion Engine
+* Every jumper combination is one row of USER_MODE_LIST. The list is expanded
+* at build time into the user_mode_t enum and a const table in flash, so a
+* new mode is one new row, and the host tools can expand it again to name and
+* test every mode.
+*
+* Columns:
+*   name       USER_MODE_<name>
+*   jumpers    JP3 JP2 JP1, as read on boot
+*   range      Random movements are +- range units on each axis, the
+*              Keep-Awake nudge is range units out and back, and the
+*              Wheel nudge range ticks
+*   speed      Units (Mouse Instructions) per second, 0 is unlimited. Kept
+*              the same whatever interval the host polls at
+*   ramp       Acceleration Profile time to reach the speed, ms. 0 is off
+*   cap        Steps packed into each Report, per axis, at least. Raised
+*              when the speed needs more, and the Profile, when on, limits
+*              the whole Report instead
+*   plan       Path generator, user_mode_plan_t. RANDOM_ENDPOINTS picks
+*              independent or Halton endpoints for every random mode
+*
+* The settings are macros from funconfig.h, or the defaults in insomniac.c,
+* so they must be defined before the list is expanded.
+*
+* ADBeta (c) 2026
+******************************************************************************/
+#ifndef INSOMNIAC_USER_MODES_H
+#define INSOMNIAC_USER_MODES_H
+
+#include <stdint.h>
+
+/// @brief Path generator of a User Mode
+typedef enum {
+	USER_MODE_PLAN_RANDOM    = 0,   // Lines to random endpoints
+	USER_MODE_PLAN_COVER,           // Lines along a Halton sequence, halton.h
+	USER_MODE_PLAN_PATTERN,         // Curves from patterns.h
+	USER_MODE_PLAN_PLAYBACK,        // Recordings from recordings.h
+	USER_MODE_PLAN_KEEP_AWAKE,      // Out and back nudge every few seconds
+	USER_MODE_PLAN_WHEEL            // The same, on the wheel
+} user_mode_plan_t;
+
+
+//       name        jumpers  range             speed          ramp             cap              plan
+#define USER_MODE_LIST(X) \
+	X(NORMAL,     0b000,   125,              RANDOM_SPEED,  PROFILE_RAMP_MS, REPORT_STEP_CAP, RANDOM_ENDPOINTS)          \
+	X(HI_RES,     0b001,   250,              RANDOM_SPEED,  PROFILE_RAMP_MS, REPORT_STEP_CAP, RANDOM_ENDPOINTS)          \
+	X(JITTER,     0b010,   20,               RANDOM_SPEED,  PROFILE_RAMP_MS, REPORT_STEP_CAP, RANDOM_ENDPOINTS)          \
+	X(STEPPED,    0b011,   2,                STEPPED_SPEED, 0,               REPORT_STEP_CAP, USER_MODE_PLAN_RANDOM)     \
+	X(PATTERN,    0b100,   0,                PATTERN_SPEED, 0,               REPORT_STEP_CAP, USER_MODE_PLAN_PATTERN)    \
+	X(PLAYBACK,   0b101,   0,                PATTERN_SPEED, 0,               REPORT_STEP_CAP, USER_MODE_PLAN_PLAYBACK)   \
+	X(KEEP_AWAKE, 0b110,   KEEP_AWAKE_NUDGE, 0,             0,               REPORT_STEP_CAP, USER_MODE_PLAN_KEEP_AWAKE) \
+	X(WHEEL,      0b111,   WHEEL_NUDGE,      0,             0,               1,               USER_MODE_PLAN_WHEEL)
+
+
+// User Mode Selection from the Jumpers - Reads the jumpers in binary on boot
+#define USER_MODE_ENUM(name, jumpers, range, speed, ramp, cap, plan) \
+	USER_MODE_##name = jumpers,
+typedef enum {
+	USER_MODE_LIST(USER_MODE_ENUM)
+} user_mode_t;
+#undef USER_MODE_ENUM
+
+#define USER_MODE_COUNT        8
+
+// Every jumper combination must have a row
+#define USER_MODE_ROW(name, jumpers, range, speed, ramp, cap, plan)  + 1
+#if (0 USER_MODE_LIST(USER_MODE_ROW)) != USER_MODE_COUNT
+	#error "USER_MODE_LIST must have a row for every jumper combination"
+#endif
+#undef USER_MODE_ROW
+
+
+/// @brief Settings of one User Mode, one row of USER_MODE_LIST
+typedef struct {
+	int16_t          range;
+	uint16_t         speed;
+	uint16_t         ramp_ms;
+	int8_t           report_cap;
+	user_mode_plan_t plan;
+} user_mode_desc_t;
+
+
+/// @brief Expands USER_MODE_LIST into a table of user_mode_desc_t, indexed
+/// by the jumpers. Expand it once, after the settings are defined
+#define USER_MODE_DESC(name, jumpers, range, speed, ramp, cap, plan) \
+	[jumpers] = {range, speed, ramp, cap, plan},
+#define USER_MODE_TABLE(table) \
+	const user_mode_desc_t table[USER_MODE_COUNT] = { USER_MODE_LIST(USER_MODE_DESC) }
+
+#endif
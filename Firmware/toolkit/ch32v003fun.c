@@ -215,7 +215,6 @@ WEAK int wctomb(char *s, wchar_t wc)
 #endif
 WEAK size_t strlen(const char *s) { const char *a = s;for (; *s; s++);return s-a; }
 WEAK size_t strnlen(const char *s, size_t n) { const char *p = memchr(s, 0, n); return p ? (size_t)(p-s) : n;}
-WEAK void *memset(void *dest, int c, size_t n) { unsigned char *s = dest; for (; n; n--, s++) *s = c; return dest; }
 WEAK char *strcpy(char *d, const char *s) { for (; (*d=*s); s++, d++); return d; }
 WEAK char *strncpy(char *d, const char *s, size_t n) { for (; n && (*d=*s); n--, s++, d++); return d; }
 WEAK int strcmp(const char *l, const char *r)
@@ -405,20 +404,198 @@ WEAK char *strrchr(const char *s, int c)
 	return __memrchr(s, c, strlen(s) + 1);
 }
 
-WEAK void *memcpy(void *dest, const void *src, size_t n)
+/* Word-wide memory functions - BEGIN
+ * rv32ec has no misaligned word access, so these line the pointers up with
+ * byte steps, move whole words, and finish with an unrolled tail. Shorter
+ * than FUN_MEM_WORD_MIN bytes it isn't worth lining up. The words are
+ * may_alias, so LTO can inline these without breaking strict aliasing, and
+ * loop pattern matching is off so GCC can't turn a loop back into a call to
+ * the function it is in. make host-memory tests them on the host. */
+#define FUN_MEM_WORD_MIN 8
+#define FUN_MEM_NO_LIBCALL __attribute__((optimize("no-tree-loop-distribute-patterns")))
+typedef uint32_t __attribute__((may_alias)) fun_mem_word_t;
+
+WEAK FUN_MEM_NO_LIBCALL void *memset(void *dest, int c, size_t n)
+{
+	unsigned char *s = dest;
+
+	if (n >= FUN_MEM_WORD_MIN) {
+		for (; (uintptr_t)s & 3; n--) *s++ = c;
+
+		/* The byte in every lane, with shifts as there is no multiply */
+		uint32_t w = (unsigned char)c;
+		w |= w << 8;
+		w |= w << 16;
+
+		fun_mem_word_t *ws = (fun_mem_word_t *)s;
+		for (; n >= 16; n -= 16, ws += 4) {
+			ws[0] = w; ws[1] = w; ws[2] = w; ws[3] = w;
+		}
+		for (; n >= 4; n -= 4) *ws++ = w;
+		s = (unsigned char *)ws;
+	}
+
+	/* At most 7 bytes left */
+	if (n & 4) { s[0] = c; s[1] = c; s[2] = c; s[3] = c; s += 4; }
+	if (n & 2) { s[0] = c; s[1] = c; s += 2; }
+	if (n & 1) *s = c;
+	return dest;
+}
+
+WEAK FUN_MEM_NO_LIBCALL void *memcpy(void *dest, const void *src, size_t n)
 {
 	unsigned char *d = dest;
 	const unsigned char *s = src;
-	for (; n; n--) *d++ = *s++;
+
+	/* Words only when both pointers reach a boundary together */
+	if (n >= FUN_MEM_WORD_MIN && !(((uintptr_t)d ^ (uintptr_t)s) & 3)) {
+		for (; (uintptr_t)d & 3; n--) *d++ = *s++;
+
+		fun_mem_word_t *wd = (fun_mem_word_t *)d;
+		const fun_mem_word_t *ws = (const fun_mem_word_t *)s;
+		for (; n >= 16; n -= 16, wd += 4, ws += 4) {
+			wd[0] = ws[0]; wd[1] = ws[1]; wd[2] = ws[2]; wd[3] = ws[3];
+		}
+		for (; n >= 4; n -= 4) *wd++ = *ws++;
+		d = (unsigned char *)wd;
+		s = (const unsigned char *)ws;
+	}
+
+	/* Mismatched pointers go 4 bytes a pass, then the last 3 */
+	for (; n >= 4; n -= 4, d += 4, s += 4) {
+		d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = s[3];
+	}
+	if (n & 2) { d[0] = s[0]; d[1] = s[1]; d += 2; s += 2; }
+	if (n & 1) *d = *s;
 	return dest;
 }
 
-WEAK int memcmp(const void *vl, const void *vr, size_t n)
+WEAK FUN_MEM_NO_LIBCALL int memcmp(const void *vl, const void *vr, size_t n)
 {
 	const unsigned char *l=vl, *r=vr;
+
+	/* Skip equal words, the byte loop finds the first difference */
+	if (n >= FUN_MEM_WORD_MIN && !(((uintptr_t)l ^ (uintptr_t)r) & 3)) {
+		for (; (uintptr_t)l & 3; n--, l++, r++)
+			if (*l != *r) return *l-*r;
+
+		const fun_mem_word_t *wl = (const fun_mem_word_t *)l;
+		const fun_mem_word_t *wr = (const fun_mem_word_t *)r;
+		for (; n >= 4 && *wl == *wr; n -= 4) { wl++; wr++; }
+		l = (const unsigned char *)wl;
+		r = (const unsigned char *)wr;
+	}
+
 	for (; n && *l == *r; n--, l++, r++);
 	return n ? *l-*r : 0;
 }
+/* Word-wide memory functions - END */
+
+/* Soft multiply and divide - BEGIN
+ * rv32ec has no M extension, so GCC calls these for every 32 bit * / and %.
+ * They replace the libgcc ones, which take a loop pass for every bit.
+ * Multiply loops on the smaller operand, 4 bits a pass. Divide returns
+ * early when the divisor is the bigger, shifts for powers of two, lines the
+ * divisor up 4 bits at a time, then takes quotient bits 4 a pass. Division
+ * by zero gives what the M extension does, all ones and the dividend. GCC
+ * only calls these after LTO has run, used keeps LTO from dropping them.
+ * make host-muldiv tests them on the host. */
+#define FUN_MATH_LIBCALL __attribute__((used, noinline))
+
+/* One quotient bit, the remainder and divisor lined up */
+#define FUN_DIV_STEP() \
+	do { q <<= 1; if (n >= d) { n -= d; q |= 1; } d >>= 1; } while (0)
+
+WEAK FUN_MATH_LIBCALL uint32_t __mulsi3(uint32_t a, uint32_t b)
+{
+	uint32_t p = 0;
+
+	if (a < b) { uint32_t t = a; a = b; b = t; }
+
+	while (b) {
+		if (b & 1) p += a;
+		if (b & 2) p += a << 1;
+		if (b & 4) p += a << 2;
+		if (b & 8) p += a << 3;
+		a <<= 4;
+		b >>= 4;
+	}
+	return p;
+}
+
+static inline uint32_t fun_udivmod(uint32_t n, uint32_t d, uint32_t *rem)
+{
+	uint32_t q = 0;
+	int s = 0, passes;
+
+	if (d > n) { *rem = n; return 0; }
+	if (d == 0) { *rem = n; return 0xFFFFFFFF; }
+
+	/* Powers of two are a shift and a mask */
+	if (!(d & (d - 1))) {
+		*rem = n & (d - 1);
+		while (d > 15) { d >>= 4; s += 4; }
+		while (d > 1) { d >>= 1; s++; }
+		return n >> s;
+	}
+
+	/* Shift the divisor up to the dividend's top bit, small quotients are
+	 * quick to line up */
+	while ((n >> 4) >= d) { d <<= 4; s += 4; }
+	while ((n >> 1) >= d) { d <<= 1; s++; }
+
+	/* s + 1 quotient bits, unrolled 4 to a pass. The first pass jumps in
+	 * part way, so each case falls through to the next */
+	passes = (s + 4) >> 2;
+	switch (s & 3) {
+	case 3: do {	FUN_DIV_STEP();
+		/* fallthrough */
+	case 2:		FUN_DIV_STEP();
+		/* fallthrough */
+	case 1:		FUN_DIV_STEP();
+		/* fallthrough */
+	case 0:		FUN_DIV_STEP();
+		} while (--passes);
+	}
+
+	*rem = n;
+	return q;
+}
+
+WEAK FUN_MATH_LIBCALL uint32_t __udivsi3(uint32_t n, uint32_t d)
+{
+	uint32_t r;
+	return fun_udivmod(n, d, &r);
+}
+
+WEAK FUN_MATH_LIBCALL uint32_t __umodsi3(uint32_t n, uint32_t d)
+{
+	uint32_t r;
+	fun_udivmod(n, d, &r);
+	return r;
+}
+
+/* The quotient is negative when the signs differ, the remainder takes the
+ * dividend's sign. INT_MIN / -1 comes out as INT_MIN, like the M extension */
+WEAK FUN_MATH_LIBCALL int32_t __divsi3(int32_t a, int32_t b)
+{
+	uint32_t r, q;
+
+	if (b == 0) return -1;
+	q = fun_udivmod(a < 0 ? 0 - (uint32_t)a : (uint32_t)a,
+	                b < 0 ? 0 - (uint32_t)b : (uint32_t)b, &r);
+	return (int32_t)(((a ^ b) < 0) ? 0 - q : q);
+}
+
+WEAK FUN_MATH_LIBCALL int32_t __modsi3(int32_t a, int32_t b)
+{
+	uint32_t r;
+
+	fun_udivmod(a < 0 ? 0 - (uint32_t)a : (uint32_t)a,
+	            b < 0 ? 0 - (uint32_t)b : (uint32_t)b, &r);
+	return (int32_t)((a < 0) ? 0 - r : r);
+}
+/* Soft multiply and divide - END */
 
 
 WEAK void *memmove(void *dest, const void *src, size_t n)
@@ -476,47 +653,62 @@ WEAK int puts(const char *s)
  *
  */
 
+/* Mini printf - BEGIN */
 #define mini_strlen strlen
 
+/* rv32ec has no divide, and a libgcc divide and modulo for every digit
+ * costs thousands of cycles a number. Decimal subtracts each power of ten
+ * instead, at most 9 times a digit, and the radixes that are whole bits
+ * take digits with shifts. Both write the digits front to back, so there
+ * is no reversing. Works on 32 bits, which also makes %u and %x right for
+ * values with the top bit set. make host-printf tests it on the host. */
+static const uint32_t mini_pow10[] = {
+	1000000000, 100000000, 10000000, 1000000, 100000,
+	10000, 1000, 100, 10, 1
+};
+
 static int
 mini_itoa(long value, unsigned int radix, int uppercase, int unsig,
 	 char *buffer)
 {
 	char	*pbuffer = buffer;
-	int	negative = 0;
-	int	i, len;
+	uint32_t	u = (uint32_t)value;
 
 	/* No support for unusual radixes. */
-	if (radix > 16)
+	if (radix != 10 && (radix < 2 || radix > 16 || (radix & (radix - 1))))
 		return 0;
 
-	if (value < 0 && !unsig) {
-		negative = 1;
-		value = -value;
+	if (!unsig && (int32_t)u < 0) {
+		*(pbuffer++) = '-';
+		u = 0 - u;
 	}
 
-	/* This builds the string back to front ... */
-	do {
-		int digit = value % radix;
-		*(pbuffer++) = (digit < 10 ? '0' + digit : (uppercase ? 'A' : 'a') + digit - 10);
-		value /= radix;
-	} while (value > 0);
-
-	if (negative)
-		*(pbuffer++) = '-';
+	if (radix == 10) {
+		const uint32_t *p = mini_pow10;
+		if (u < 100000) p += 5;
+		while (*p > u && *p != 1) p++;
+		for (;; p++) {
+			char digit = '0';
+			while (u >= *p) {
+				u -= *p;
+				digit++;
+			}
+			*(pbuffer++) = digit;
+			if (*p == 1) break;
+		}
+	} else {
+		int bits = (radix >= 16) ? 4 : (radix >= 8) ? 3 : (radix >= 4) ? 2 : 1;
+		int shift = 0;
+		while ((u >> shift) >> bits) shift += bits;
+		for (; shift >= 0; shift -= bits) {
+			int digit = (u >> shift) & (radix - 1);
+			*(pbuffer++) = (digit < 10 ? '0' + digit : (uppercase ? 'A' : 'a') + digit - 10);
+		}
+	}
 
 	*(pbuffer) = '\0';
 
-	/* ... now we reverse it (could do it recursively but will
-	 * conserve the stack space) */
-	len = (pbuffer - buffer);
-	for (i = 0; i < len / 2; i++) {
-		char j = buffer[i];
-		buffer[i] = buffer[len-i-1];
-		buffer[len-i-1] = j;
-	}
-
-	return len;
+	return pbuffer - buffer;
 }
 
 static int
@@ -654,8 +846,13 @@ mini_vpprintf(int (*puts)(char* s, int len, void* buf), void* buf, const char *f
 							len = mini_itoa((long) va_arg(va, int), 10, 0, 0, bf2);
 						}
 					}
-					len = mini_pad(bf2, len, pad_char, pad_to, bf);
-					len = puts(bf, len, buf);
+					/* Unpadded numbers go straight out */
+					if (pad_to > 0) {
+						len = mini_pad(bf2, len, pad_char, pad_to, bf);
+						len = puts(bf, len, buf);
+					} else {
+						len = puts(bf2, len, buf);
+					}
 					break;
 
 				case 'x':
@@ -665,8 +862,12 @@ mini_vpprintf(int (*puts)(char* s, int len, void* buf), void* buf, const char *f
 					} else {
 						len = mini_itoa((unsigned long) va_arg(va, unsigned int), 16, (ch=='X'), 1, bf2);
 					}
-					len = mini_pad(bf2, len, pad_char, pad_to, bf);
-					len = puts(bf, len, buf);
+					if (pad_to > 0) {
+						len = mini_pad(bf2, len, pad_char, pad_to, bf);
+						len = puts(bf, len, buf);
+					} else {
+						len = puts(bf2, len, buf);
+					}
 					break;
 
 				case 'c' :
@@ -735,6 +936,7 @@ mini_pprintf(int (*puts)(char*s, int len, void* buf), void* buf, const char *fmt
 
 	return ret;
 }
+/* Mini printf - END */
 
 
 /*